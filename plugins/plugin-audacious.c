@@ -33,6 +33,8 @@
 static int acmx_seek_to = -1;
 
 static int acmx_open_vfs(ACMStream **acm_p, const gchar *url);
+static int acmx_probe_vfs(const gchar *url, ACMInfo *info,
+			  unsigned *total, unsigned *raw_len);
 
 /*
  * useful stuff
@@ -52,18 +54,17 @@ static gchar *get_title(const gchar * filename)
 
 static gint acmx_is_our_file(const gchar * filename)
 {
-	ACMStream *acm;
+	ACMInfo info;
 
-	if (acmx_open_vfs(&acm, filename) < 0)
+	if (acmx_probe_vfs(filename, &info, NULL, NULL) < 0)
 		return FALSE;
-	acm_close(acm);
 	return TRUE;
 }
 
 static Tuple *acmx_get_song_tuple(const gchar * filename)
 {
-	ACMStream *acm;
-	const ACMInfo *info;
+	ACMInfo info;
+	unsigned total, raw_len;
 	int err;
 	Tuple *tup = NULL;
 	char buf[512];
@@ -73,7 +74,7 @@ static Tuple *acmx_get_song_tuple(const gchar * filename)
 	if (!ext || strcasecmp(ext, ".acm") != 0)
 		return NULL;
 
-	if ((err = acmx_open_vfs(&acm, filename)) < 0)
+	if ((err = acmx_probe_vfs(filename, &info, &total, &raw_len)) < 0)
 		return NULL;
 
 	tup = tuple_new_from_filename(filename);
@@ -82,18 +83,16 @@ static Tuple *acmx_get_song_tuple(const gchar * filename)
 	tuple_associate_string(tup, FIELD_TITLE, NULL, title);
 	g_free(title);
 
-	info = acm_info(acm);
 	snprintf(buf, sizeof(buf), "acm-level=%d acm-subblocks=%d",
-		 info->acm_level, info->acm_rows);
+		 info.acm_level, info.acm_rows);
 	tuple_associate_string(tup, FIELD_COMMENT, NULL, buf);
 
-	tuple_associate_int(tup, FIELD_LENGTH, NULL, acm_time_total(acm));
-	tuple_associate_int(tup, FIELD_BITRATE, NULL, acm_bitrate(acm) / 1024);
+	tuple_associate_int(tup, FIELD_LENGTH, NULL, acm_probe_time(&info, total));
+	tuple_associate_int(tup, FIELD_BITRATE, NULL,
+			    acm_probe_bitrate(&info, total, raw_len) / 1024);
 	tuple_associate_string(tup, FIELD_CODEC, NULL, "InterPlay ACM");
 	tuple_associate_string(tup, FIELD_MIMETYPE, NULL, "application/acm");
 	tuple_associate_string(tup, FIELD_QUALITY, NULL, "lossy");
-	
-	acm_close(acm);
 	return tup;
 }
 
@@ -152,6 +151,9 @@ static void play_file(InputPlayback *pback)
 	if ((err = acmx_open_vfs(&acm, filename)) < 0)
 		return;
 
+	/* remember block positions, makes seeking back cheap */
+	acm_enable_seek_index(acm);
+
 	pback->set_params(pback, NULL, 0, acm_bitrate(acm), acm_rate(acm), acm_channels(acm));
 
 	res = pback->output->open_audio(FMT_S16_LE, acm_rate(acm), acm_channels(acm));
@@ -282,3 +284,27 @@ static int acmx_open_vfs(ACMStream **acm_p, const gchar *url)
 	return res;
 }
 
+/* header only, see acm_probe() */
+static int acmx_probe_vfs(const gchar *url, ACMInfo *info,
+			  unsigned *total, unsigned *raw_len)
+{
+	VFSFile *stream;
+	unsigned char hdr[14 + 28];	/* WAVC and ACM headers */
+	int got, len;
+
+	stream = vfs_fopen(url, "r");
+	if (stream == NULL)
+		return ACM_ERR_OPEN;
+
+	got = vfs_fread(hdr, 1, sizeof(hdr), stream);
+	len = vfs_fsize(stream);
+	vfs_fclose(stream);
+
+	if (raw_len)
+		*raw_len = len > 0 ? len : 0;
+
+	if (got <= 0)
+		return ACM_ERR_NOT_ACM;
+	return acm_probe(hdr, got, info, total);
+}
+
@@ -63,6 +63,7 @@ typedef struct AcmDec {
 
 	GstPad *srcpad, *sinkpad;
 	ACMStream *ctx;
+	acm_ring *ring;		/* decodes ahead of ctx users */
 
 	int fileofs;
 	gboolean discont;
@@ -171,6 +172,13 @@ static void acmdec_detect_file(GstTypeFind *find, gpointer junk)
 
 /*
  * Fire reader with gst_pad_pull_range()
+ *
+ * After acmdec_init_decoder() these run on the ring producer
+ * thread, not on the pad task.  Pulling is allowed from any thread
+ * while sinkpad is active in pull mode, and the producer is the only
+ * user of ctx and fileofs until acm_ring_free() joins it.  So the
+ * ring is stopped in acmdec_sink_activate_pull() before the pad goes
+ * down, a pull after that would race with upstream shutdown.
  */
 
 static int acmdec_pull_read(void *dst, int size, int n, void *arg)
@@ -356,6 +364,17 @@ static gboolean acmdec_init_decoder(AcmDec *acm)
 	}
 	GST_DEBUG_OBJECT(acm, "size=%d samples=%d", acm->ctx->data_len, acm->ctx->total_values);
 
+	/* remember block positions, makes seeking back cheap */
+	acm_enable_seek_index(acm->ctx);
+
+	acm->ring = acm_ring_new(acm->ctx, 0, ACM_NATIVE_BE);
+	if (!acm->ring) {
+		GST_ERROR_OBJECT(acm, "cannot start decoding");
+		acm_close(acm->ctx);
+		acm->ctx = NULL;
+		return FALSE;
+	}
+
 	caps = gst_caps_from_string(BASE_CAPS);
 	gst_caps_set_simple(caps,
 			    "channels", G_TYPE_INT, acm_channels(acm->ctx),
@@ -377,6 +396,8 @@ static void acmdec_reset(AcmDec *acm)
 {
 	GST_DEBUG_OBJECT(acm, "do reset");
 	if (acm->ctx) {
+		acm_ring_free(acm->ring);
+		acm->ring = NULL;
 		acm_close(acm->ctx);
 		acm->ctx = NULL;
 	}
@@ -426,7 +447,7 @@ acmdec_src_query (GstPad *pad, GstQuery *query)
 		if (acm->seek_to_pcm >= 0)
 			pcmval = acm->seek_to_pcm;
 		else
-			pcmval = acm_pcm_tell(acm->ctx);
+			pcmval = acm_ring_tell(acm->ring);
 		res = acmdec_convert(acm, GST_FORMAT_DEFAULT, pcmval, &fmt, &val);
 		if (res)
 			gst_query_set_position(query, fmt, val);
@@ -496,7 +517,7 @@ static gboolean handle_seek(AcmDec *acm, GstEvent *event)
 	}
 
 	GST_DEBUG_OBJECT(acm, "do_seek: newpos=%llu curpos=%d",
-			 pcmpos, (int)acm_pcm_tell(acm->ctx));
+			 pcmpos, (int)acm_ring_tell(acm->ring));
 
 	/*
 	 * Set seek pos.  Lock as touched from play thread too.
@@ -547,6 +568,7 @@ static GstFlowReturn acmdec_src_get_range(GstPad *srcpad, guint64 offset, guint
 {
 	AcmDec *acm = ACMDEC(GST_PAD_PARENT(srcpad));
 	unsigned int req_pos;
+	const void *data;
 	int got, frame;
 	gint64 pcmpos, pcmlen;
 	GstFlowReturn flow = GST_FLOW_ERROR;
@@ -569,13 +591,19 @@ static GstFlowReturn acmdec_src_get_range(GstPad *srcpad, guint64 offset, guint
 	}
 
 	req_pos = offset / frame;
-	if (acm_pcm_tell(acm->ctx) != req_pos) {
-		GST_INFO_OBJECT(acm, "seeking: cur=%d, new=%d", acm_pcm_tell(acm->ctx), req_pos);
-		if (acm_seek_pcm(acm->ctx, req_pos) < 0) {
+	if (acm_ring_tell(acm->ring) != req_pos) {
+		GST_INFO_OBJECT(acm, "seeking: cur=%d, new=%d", acm_ring_tell(acm->ring), req_pos);
+		if (acm_ring_seek(acm->ring, req_pos) < 0) {
 			GST_ERROR_OBJECT(acm, "seek failed");
 			goto error;
 		}
-		if (acm_pcm_tell(acm->ctx) != req_pos) {
+
+		/* position is exact after peek */
+		if (acm_ring_peek(acm->ring, &data) < 0) {
+			GST_ERROR_OBJECT(acm, "seek failed");
+			goto error;
+		}
+		if (acm_ring_tell(acm->ring) != req_pos) {
 			GST_ERROR_OBJECT(acm, "seek failed to reach right pos");
 			goto error;
 		}
@@ -586,10 +614,10 @@ static GstFlowReturn acmdec_src_get_range(GstPad *srcpad, guint64 offset, guint
 	if (flow != GST_FLOW_OK)
 		goto error;
 
-	pcmpos = acm_pcm_tell(acm->ctx);
-	got = acm_read_loop(acm->ctx, GST_BUFFER_DATA(*buf), size, ACM_NATIVE_BE, 2, 1);
+	pcmpos = acm_ring_tell(acm->ring);
+	got = acm_ring_read(acm->ring, GST_BUFFER_DATA(*buf), size);
 	if (got < 0) {
-		GST_ERROR_OBJECT(acm, "acm_read_loop: %s", acm_strerror(got));
+		GST_ERROR_OBJECT(acm, "acm_ring_read: %s", acm_strerror(got));
 		/* tag it still as EOS */
 		flow = GST_FLOW_UNEXPECTED;
 		goto error;
@@ -622,6 +650,7 @@ static void do_real_seek(AcmDec *acm)
 {
 	int seek_to_pcm;
 	usec_t seek_time;
+	const void *data;
 
 	GST_DEBUG_OBJECT(acm, "do_real_seek");
 
@@ -637,11 +666,12 @@ static void do_real_seek(AcmDec *acm)
 
 	gst_pad_push_event (acm->srcpad, gst_event_new_flush_start ());
 
-	if (acm_seek_pcm(acm->ctx, seek_to_pcm) < 0) {
-		GST_ERROR_OBJECT(acm, "acm_seek_pcm failed");
+	if (acm_ring_seek(acm->ring, seek_to_pcm) < 0
+	    || acm_ring_peek(acm->ring, &data) < 0) {
+		GST_ERROR_OBJECT(acm, "seek failed");
 	}
 
-	GST_DEBUG_OBJECT(acm, "reached seek pos at %d", (int)acm_pcm_tell(acm->ctx));
+	GST_DEBUG_OBJECT(acm, "reached seek pos at %d", (int)acm_ring_tell(acm->ring));
 	GST_OBJECT_LOCK(acm);
 	acm->seek_to_pcm = -1;
 	acm->discont = TRUE;
@@ -670,7 +700,7 @@ static void acmdec_sink_loop(void *arg)
 		do_real_seek(acm);
 
 	frame = ACM_WORD * acm_channels(acm->ctx);
-	pcmpos = acm_pcm_tell(acm->ctx);
+	pcmpos = acm_ring_tell(acm->ring);
 	offset = pcmpos * frame;
 	size = acm->ctx->block_len * frame;
 
@@ -708,12 +738,17 @@ pause:
 
 static gboolean acmdec_sink_activate_pull (GstPad *sinkpad, gboolean active)
 {
-	GST_DEBUG_OBJECT(GST_PAD_PARENT(sinkpad), "activate_pull: %d", active);
-	if (active) {
+	AcmDec *acm = ACMDEC(GST_PAD_PARENT(sinkpad));
+	gboolean res;
+
+	GST_DEBUG_OBJECT(acm, "activate_pull: %d", active);
+	if (active)
 		return gst_pad_start_task(sinkpad, acmdec_sink_loop, sinkpad);
-	} else {
-		return gst_pad_stop_task(sinkpad);
-	}
+
+	/* no consumer left, then stop producer pulling from sinkpad */
+	res = gst_pad_stop_task(sinkpad);
+	acmdec_reset(acm);
+	return res;
 }
 
 static gboolean acmdec_sink_activate (GstPad *sinkpad)
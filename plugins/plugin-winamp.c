@@ -32,6 +32,7 @@
 
 typedef struct {
 	ACMStream *acm;
+	acm_ring *ring;		/* decodes ahead of output */
 	int paused;
 	int seek_to;
 	char *filename;
@@ -43,6 +44,12 @@ static In_Module *plugin;
 static int dec_quit = 0;
 static HANDLE dec_thread = INVALID_HANDLE_VALUE;
 
+/* position of ring in ms */
+static int ring_time_tell()
+{
+	return (uint64_t)acm_ring_tell(in.ring) * 1000 / acm_rate(in.acm);
+}
+
 /*
  * module functions
  */
@@ -69,25 +76,23 @@ static int is_our_file(char *fn)
 static void get_song_info(char *filename, char *title, int *length_in_ms)
 {
 	char *fn, *p;
-	ACMStream *acm;
+	ACMInfo inf;
+	unsigned total;
 
 	if (filename && *filename) {
-		if (acm_open_file(&acm, filename, 0) < 0)
+		/* playlist scan, header is enough */
+		if (acm_probe_file(filename, &inf, &total, NULL) < 0)
 			return;
 		fn = filename;
+		*length_in_ms = acm_probe_time(&inf, total);
 	} else {
-		acm = in.acm;
 		fn = in.filename;
+		*length_in_ms = acm_time_total(in.acm);
 	}
 	if ((p = strrchr(fn, '\\')) != NULL)
 		strcpy(title, p + 1);
 	else
 		strcpy(title, fn);
-	
-	*length_in_ms = acm_time_total(acm);
-
-	if (filename && *filename)
-		acm_close(acm);
 }
 
 static void pause()
@@ -118,7 +123,7 @@ static int get_time()
 	if (in.seek_to >= 0)
 		return in.seek_to;
 	d = plugin->outMod->GetWrittenTime() - plugin->outMod->GetOutputTime();
-	return acm_time_tell(in.acm) - d;
+	return ring_time_tell() - d;
 	/* return plugin->outMod->GetOutputTime(); */
 }
 
@@ -150,7 +155,7 @@ static int read_and_play(char *buf) {
 	}
 
 	/* load samples */
-	res = acm_read_loop(in.acm, buf, blen, 0,2,1);
+	res = acm_ring_read(in.ring, buf, blen);
 	if (res <= 0)
 		return 1;
 	snum = res / (acm_channels(in.acm) * ACM_WORD);
@@ -173,10 +178,12 @@ static int read_and_play(char *buf) {
 
 static int try_seeking()
 {
-	int eof = 1, pos;
-	pos = acm_seek_time(in.acm, in.seek_to);
-	if (pos >= 0) {
-		plugin->outMod->Flush(acm_time_tell(in.acm));
+	unsigned pcm = (uint64_t)in.seek_to * acm_rate(in.acm) / 1000;
+	int eof = 1;
+
+	/* on error stop, like at end of stream */
+	if (acm_ring_seek(in.ring, pcm) >= 0) {
+		plugin->outMod->Flush(ring_time_tell());
 		eof = in.paused = 0;
 	}
 	in.seek_to = -1;
@@ -221,6 +228,10 @@ static int play(char *fn)
 	if ((err = acm_open_file(&acm, fn, 0)) < 0)
 		return 1;
 
+	/* saved index if any, else remember block positions */
+	if (acm_load_index(acm, fn) < 0)
+		acm_enable_seek_index(acm);
+
 	latency = plugin->outMod->Open(acm_rate(acm), acm_channels(acm),
 			ACM_WORD*8, -1,-1);
 	if (latency < 0) {
@@ -228,6 +239,12 @@ static int play(char *fn)
 		acm_close(acm);
 		return 1;
 	}
+	in.ring = acm_ring_new(acm, 0, 0);
+	if (in.ring == NULL) {
+		plugin->outMod->Close();
+		acm_close(acm);
+		return 1;
+	}
 	in.acm = acm;
 	in.filename = strdup(fn);
 	in.paused = 0;
@@ -262,6 +279,7 @@ static void stop()
 		CloseHandle(dec_thread);
 		dec_thread = INVALID_HANDLE_VALUE;
 	}
+	acm_ring_free(in.ring);
 	acm_close(in.acm);
 	free(in.filename);
 
@@ -272,17 +290,17 @@ static void stop()
 static int file_info_box(char *fn, HWND hwnd)
 {
 	char buf[1024];
-	ACMStream *acm;
 	int err, kbps, secs;
-	const ACMInfo *inf;
+	unsigned total, raw_len;
+	ACMInfo info;
+	const ACMInfo *inf = &info;
 	
-	err = acm_open_file(&acm, fn, 0);
+	err = acm_probe_file(fn, &info, &total, &raw_len);
 	if (err < 0)
 		return 1;
 
-	kbps = acm_bitrate(acm) / 1000;
-	secs = acm_time_total(acm) / 1000;
-	inf = acm_info(acm);
+	kbps = acm_probe_bitrate(inf, total, raw_len) / 1000;
+	secs = acm_probe_time(inf, total) / 1000;
 	
 	sprintf(buf, "%s\n\n"
 			"Length: %d:%02d\n"
@@ -294,11 +312,10 @@ static int file_info_box(char *fn, HWND hwnd)
 			"ACM num subblocks=%d\n"
 			"ACM block=%d\n",
 			fn, secs/60, secs % 60,
-			acm_pcm_total(acm), inf->rate,
+			total / inf->channels, inf->rate,
 			inf->channels, kbps,
 			inf->acm_cols, inf->acm_rows,
 			inf->acm_cols * inf->acm_rows);
-	acm_close(acm);
 
 	MessageBox(hwnd, buf, "InterPlay ACM Audio file", MB_OK);
 	return 0;
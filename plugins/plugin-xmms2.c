@@ -124,6 +124,9 @@ xmms_acm_init (xmms_xform_t *xform)
 		return FALSE;
 	}
 
+	/* remember block positions, makes seeking back cheap */
+	acm_enable_seek_index (priv->acm);
+
 	/* set metainfo */
 	xmms_xform_metadata_set_int (xform,
 				     XMMS_MEDIALIB_ENTRY_PROPERTY_DURATION,
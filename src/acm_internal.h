@@ -0,0 +1,84 @@
+/*
+ * libacm - functions shared between library sources, its tools
+ * and tests.  Not installed, not part of the API.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef __ACM_INTERNAL_H
+#define __ACM_INTERNAL_H
+
+#include "libacm.h"
+
+/*
+ * Counting is compiled in with --enable-stats, otherwise
+ * the macros are empty.
+ */
+#ifdef ACM_STATS
+#define ACM_STAT(acm, expr)	do { (acm)->stats.expr; } while (0)
+#define ACM_STAT_START(acm)	do { (acm)->stats_clock = acm_stats_clock(); } while (0)
+#define ACM_STAT_TIME(acm, field) do { \
+		uint64_t _now = acm_stats_clock(); \
+		(acm)->stats.field += _now - (acm)->stats_clock; \
+		(acm)->stats_clock = _now; \
+	} while (0)
+#else
+#define ACM_STAT(acm, expr)	do { } while (0)
+#define ACM_STAT_START(acm)	do { } while (0)
+#define ACM_STAT_TIME(acm, field) do { } while (0)
+#endif
+
+/* decode.c */
+int acm_skip_block(ACMStream *acm);
+int acm_fill_block(ACMStream *acm);
+int acm_seek_block(ACMStream *acm, unsigned word_pos);
+int acm_skip_bits(ACMStream *acm, unsigned nbits);
+void *acm_mem_alloc(ACMStream *acm, size_t size);
+void acm_mem_free(ACMStream *acm, void *ptr);
+void *acm_mem_realloc(ACMStream *acm, void *ptr, size_t old_size, size_t size);
+void acm_scalar_kernels(ACMStream *acm);
+
+/* simd.c */
+void acm_simd_init(ACMStream *acm);
+
+/* thread.c */
+typedef struct acm_thread acm_thread;
+typedef struct acm_mutex acm_mutex;
+typedef struct acm_cond acm_cond;
+acm_thread *acm_thread_start(void (*func)(void *arg), void *arg);
+void acm_thread_join(acm_thread *t);
+acm_mutex *acm_mutex_new(void);
+void acm_mutex_free(acm_mutex *m);
+void acm_mutex_lock(acm_mutex *m);
+void acm_mutex_unlock(acm_mutex *m);
+acm_cond *acm_cond_new(void);
+void acm_cond_free(acm_cond *c);
+void acm_cond_wait(acm_cond *c, acm_mutex *m);
+void acm_cond_broadcast(acm_cond *c);
+/* func runs on first call for *done, 0 initially, others wait for it */
+void acm_once(int *done, void (*func)(void));
+unsigned acm_cpu_count(void);
+
+/* util.c */
+uint64_t acm_stats_clock(void);
+int acm_wrap_independent(ACMStream *acm);
+void acm_seek_index_add(ACMStream *acm);
+const ACMSeekPoint *acm_seek_index_point(ACMStream *acm, unsigned n, const int **wrap);
+void acm_save_seek_point(ACMStream *acm, ACMSeekPoint *sp);
+int acm_restore_seek_point(ACMStream *acm, const ACMSeekPoint *sp, const int *wrap);
+int acm_rewind(ACMStream *acm);
+void acm_free_seek_index(ACMStream *acm);
+
+#endif
@@ -0,0 +1,580 @@
+/*
+ * Decoder benchmarks for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Usage: acmbench [-n samples] [-r reps] [-l level] > result.json
+ *        acmbench [-r reps] file.acm ... > result.json
+ *
+ * Streams are generated in memory: one per level with all valid
+ * fillers mixed, and one per filler at FILLER_LEVEL.  Files given
+ * are timed instead of them.  Stages are timed separately, in
+ * Msamples/s:
+ *
+ *   bits   - bit reader alone, over the whole stream
+ *   bits_old - same with 32-bit reader of libacm 1.2, see old_skip16()
+ *   skip   - acm_skip_block(), parsing only, as used by seeks
+ *   fill   - acm_fill_block(), block parsing with its bit reading
+ *   juggle - acm_read_block_ptr() minus fill
+ *   output - 16-bit output kernel over decoded samples
+ *   planar - same as stereo s16 into 2 planes, acm_read_frames()
+ *   total  - acm_read_loop() to 16-bit buffer
+ *
+ * Seeks are timed alone and until first frame after them is read.
+ * Best of reps runs is reported.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+#include "streamgen.h"
+
+#define FILLER_LEVEL	7
+#define SEEK_COUNT	64
+#define OPEN_COUNT	1000
+
+static unsigned cf_samples = 1 << 20;
+static unsigned cf_reps = 3;
+
+/* values in stream being timed */
+static unsigned cur_samples;
+
+static const char *filler_name(unsigned ind)
+{
+	static const char *names[] = {
+		"k13", "k12", "t15", "k24", "k23", "t27",
+		"k35", "k34", "bad", "k45", "k44", "bad", "t37"
+	};
+	if (ind == 0)
+		return "zero";
+	if (ind <= 16)
+		return "linear";
+	return names[ind - 17];
+}
+
+/* rows for about 16k words per block */
+static unsigned level_rows(unsigned level)
+{
+	unsigned rows = (16 * 1024) >> level;
+	if (rows < 1)
+		rows = 1;
+	if (rows > 4095)
+		rows = 4095;
+	return rows;
+}
+
+/*
+ * Bit reader of libacm 1.2, reference for the bits stage.  32-bit
+ * accumulator refilled 4 bytes at a time, byte by byte near end of
+ * buffer.  Input is copied in 64 KB pieces, as read_func gave it.
+ */
+
+#define OLD_BUFLEN	(64*1024)
+
+struct old_reader {
+	const unsigned char *src;
+	size_t src_len, src_pos;
+	unsigned char buf[OLD_BUFLEN];
+	unsigned buf_size, buf_pos;
+	unsigned bit_data, bit_avail;
+	int file_eof;
+};
+
+static void old_load_buf(struct old_reader *r)
+{
+	size_t len = r->src_len - r->src_pos;
+
+	if (r->file_eof)
+		return;
+	if (len > OLD_BUFLEN)
+		len = OLD_BUFLEN;
+	if (len == 0) {
+		/* add single zero byte */
+		r->file_eof = 1;
+		r->buf[0] = 0;
+		r->buf_size = 1;
+	} else {
+		memcpy(r->buf, r->src + r->src_pos, len);
+		r->buf_size = len;
+		r->src_pos += len;
+	}
+	r->buf_pos = 0;
+}
+
+static void old_load_bits(struct old_reader *r)
+{
+	unsigned data, got;
+	const unsigned char *p = r->buf + r->buf_pos;
+
+	switch (r->buf_size - r->buf_pos) {
+	default:
+		data = 0;
+		got = 0;
+		break;
+	case 1:
+		data = p[0];
+		got = 8;
+		break;
+	case 2:
+		data = p[0] + (p[1] << 8);
+		got = 16;
+		break;
+	case 3:
+		data = p[0] + (p[1] << 8) + (p[2] << 16);
+		got = 24;
+		break;
+	}
+
+	old_load_buf(r);
+
+	while (got < 32) {
+		if (r->buf_size - r->buf_pos == 0)
+			break;
+		data |= r->buf[r->buf_pos] << got;
+		got += 8;
+		r->buf_pos++;
+	}
+	r->bit_data = data;
+	r->bit_avail = got;
+}
+
+static int old_get_bits_reload(struct old_reader *r, unsigned bits)
+{
+	int got;
+	unsigned data, b_data, b_avail;
+
+	data = r->bit_data;
+	got = r->bit_avail;
+	bits -= got;
+
+	if (r->buf_size - r->buf_pos >= 4) {
+		const unsigned char *p = r->buf + r->buf_pos;
+		r->buf_pos += 4;
+		b_data = p[0] + (p[1] << 8) + (p[2] << 16) + ((unsigned)p[3] << 24);
+		b_avail = 32;
+	} else	{
+		old_load_bits(r);
+		if (r->bit_avail < bits)
+			return ACM_ERR_UNEXPECTED_EOF;
+		b_data = r->bit_data;
+		b_avail = r->bit_avail;
+	}
+
+	data |= (b_data & ((1 << bits) - 1)) << got;
+	r->bit_data = b_data >> bits;
+	r->bit_avail = b_avail - bits;
+	return data;
+}
+
+/*
+ * GET_BITS(tmp, acm, 16) as it was, 0 or error like
+ * acm_skip_bits().  Not inlined, so each read is a call
+ * as in the bits stage.
+ */
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static int old_skip16(struct old_reader *r)
+{
+	int tmp;
+
+	if (r->bit_avail >= 16) {
+		tmp = r->bit_data & 0xFFFF;
+		r->bit_data >>= 16;
+		r->bit_avail -= 16;
+	} else
+		tmp = old_get_bits_reload(r, 16);
+	return tmp < 0 ? tmp : 0;
+}
+
+/*
+ * Timing
+ */
+
+static double now_sec(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static ACMStream *open_mem(const struct gen_writer *w)
+{
+	ACMStream *acm;
+	int err = acm_open_memory(&acm, w->buf, w->len, 1);
+	if (err < 0) {
+		fprintf(stderr, "acmbench: cannot open stream: %d\n", err);
+		exit(1);
+	}
+	return acm;
+}
+
+enum { T_BITS, T_BITS_OLD, T_SKIP, T_FILL, T_PTR, T_OUTPUT, T_PLANAR, T_TOTAL, T_COUNT };
+
+static double run_stage(const struct gen_writer *w, int stage)
+{
+	static unsigned char outbuf[64 * 1024];
+	ACMStream *acm = open_mem(w);
+	const int *src;
+	static struct old_reader old;
+	int *pcm = NULL;
+	unsigned char *tmp = NULL;
+	void *planes[2];
+	unsigned got = 0;
+	double t;
+	int n;
+
+	if (stage == T_OUTPUT || stage == T_PLANAR) {
+		/* decode first, time only the output kernel */
+		pcm = (int *)malloc(cur_samples * sizeof(int));
+		tmp = (unsigned char *)malloc(cur_samples * ACM_WORD);
+		if (!pcm || !tmp) {
+			fprintf(stderr, "acmbench: out of memory\n");
+			exit(1);
+		}
+		while ((n = acm_read_block_ptr(acm, &src, acm->block_len)) > 0) {
+			memcpy(pcm + got, src, n * sizeof(int));
+			got += n;
+		}
+	}
+
+	t = now_sec();
+	switch (stage) {
+	case T_BITS:
+		/* short reads, long ones step over whole bytes */
+		while (acm_skip_bits(acm, 16) == 0)
+			;
+		break;
+	case T_BITS_OLD:
+		/* whole file, header included */
+		memset(&old, 0, sizeof(old));
+		old.src = w->buf;
+		old.src_len = w->len;
+		while (old_skip16(&old) == 0)
+			;
+		break;
+	case T_SKIP:
+		while (acm_skip_block(acm) > 0)
+			;
+		break;
+	case T_FILL:
+		while (acm_fill_block(acm) > 0)
+			;
+		break;
+	case T_PTR:
+		while (acm_read_block_ptr(acm, &src, acm->block_len) > 0)
+			;
+		break;
+	case T_OUTPUT:
+		acm->out_func[ACM_OUT_S16LE](pcm, tmp, got, acm->info.acm_level);
+		break;
+	case T_PLANAR:
+		/* as stereo s16 */
+		planes[0] = tmp;
+		planes[1] = tmp + got / 2 * ACM_WORD;
+		acm->planar2_func[ACM_SAMPLE_S16](pcm, 2, planes, 2, 0, got / 2,
+						  acm->info.acm_level);
+		break;
+	case T_TOTAL:
+		while (acm_read_loop(acm, outbuf, sizeof(outbuf), 0, 2, 1) > 0)
+			;
+		break;
+	}
+	t = now_sec() - t;
+
+	free(pcm);
+	free(tmp);
+	acm_close(acm);
+	return t;
+}
+
+/* negative if below timer resolution, eg. no juggle on level 0 */
+static double msps(double t)
+{
+	if (t < 1e-5)
+		return -1;
+	return cur_samples / t / 1e6;
+}
+
+static void bench_stream(const struct gen_writer *w, double *res)
+{
+	double best[T_COUNT];
+	unsigned i, s;
+
+	for (s = 0; s < T_COUNT; s++)
+		best[s] = 1e9;
+	for (i = 0; i < cf_reps; i++) {
+		for (s = 0; s < T_COUNT; s++) {
+			double t = run_stage(w, s);
+			if (t < best[s])
+				best[s] = t;
+		}
+	}
+	res[T_BITS] = msps(best[T_BITS]);
+	res[T_BITS_OLD] = msps(best[T_BITS_OLD]);
+	res[T_SKIP] = msps(best[T_SKIP]);
+	res[T_FILL] = msps(best[T_FILL]);
+	res[T_PTR] = msps(best[T_PTR] - best[T_FILL]);
+	res[T_OUTPUT] = msps(best[T_OUTPUT]);
+	res[T_PLANAR] = msps(best[T_PLANAR]);
+	res[T_TOTAL] = msps(best[T_TOTAL]);
+}
+
+static void print_stages(const double *res)
+{
+	static const char *names[T_COUNT] = {
+		"bits", "bits_old", "skip", "fill", "juggle", "output", "planar", "total"
+	};
+	unsigned s;
+
+	for (s = 0; s < T_COUNT; s++) {
+		if (res[s] < 0)
+			printf("%s\"%s\": null", s ? ", " : "", names[s]);
+		else
+			printf("%s\"%s\": %.1f", s ? ", " : "", names[s], res[s]);
+	}
+}
+
+/*
+ * Seek and open latency
+ */
+
+/*
+ * Average microseconds per seek to random positions.  With first,
+ * until first frame after it is read.
+ */
+static double bench_seek(const struct gen_writer *w, int indexed, int first)
+{
+	ACMStream *acm = open_mem(w);
+	struct gen_writer r;
+	unsigned i, total = acm_pcm_total(acm);
+	short frame[2];
+	double t;
+
+	if (indexed)
+		acm_build_seek_index(acm);
+	r.seed = 12345;
+	t = now_sec();
+	for (i = 0; i < SEEK_COUNT; i++) {
+		acm_seek_pcm(acm, gen_rnd(&r, total));
+		if (first)
+			acm_read(acm, frame, acm->info.channels * ACM_WORD, 0,2,1);
+	}
+	t = now_sec() - t;
+	acm_close(acm);
+	return t * 1e6 / SEEK_COUNT;
+}
+
+struct mem_file {
+	const struct gen_writer *w;
+	unsigned pos;
+};
+
+static int mem_read(void *dst, int size, int n, void *arg)
+{
+	struct mem_file *f = (struct mem_file *)arg;
+	unsigned len = size * n;
+	if (len > f->w->len - f->pos)
+		len = f->w->len - f->pos;
+	memcpy(dst, f->w->buf + f->pos, len);
+	f->pos += len;
+	return len;
+}
+
+static int mem_seek(void *arg, int ofs, int whence)
+{
+	struct mem_file *f = (struct mem_file *)arg;
+	if (whence == SEEK_CUR)
+		ofs += f->pos;
+	else if (whence == SEEK_END)
+		ofs += f->w->len;
+	if (ofs < 0 || (unsigned)ofs > f->w->len)
+		return -1;
+	f->pos = ofs;
+	return 0;
+}
+
+static int mem_length(void *arg)
+{
+	return ((struct mem_file *)arg)->w->len;
+}
+
+/* average microseconds for acm_open_decoder() + acm_close() */
+static double bench_open(const struct gen_writer *w)
+{
+	static const acm_io_callbacks cb = {
+		mem_read, mem_seek, NULL, mem_length
+	};
+	struct mem_file f;
+	ACMStream *acm;
+	unsigned i;
+	double t;
+
+	f.w = w;
+	t = now_sec();
+	for (i = 0; i < OPEN_COUNT; i++) {
+		f.pos = 0;
+		if (acm_open_decoder(&acm, &f, cb, 1) < 0)
+			return -1;
+		acm_close(acm);
+	}
+	t = now_sec() - t;
+	return t * 1e6 / OPEN_COUNT;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: acmbench [-n samples] [-r reps] [-l level]\n"
+		"       acmbench [-r reps] file.acm ...\n");
+	exit(1);
+}
+
+static void print_json_str(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			putchar('\\');
+		if ((unsigned char)*str >= 0x20)
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+/* stages on real files, read into memory */
+static int bench_files(char **files, unsigned nfiles)
+{
+	struct gen_writer w;
+	double res[T_COUNT];
+	ACMStream *acm;
+	FILE *fp;
+	long len;
+	unsigned i;
+
+	printf("{\n\"version\": \"%s\",\n\"reps\": %u,\n\"files\": [\n",
+	       LIBACM_VERSION, cf_reps);
+	for (i = 0; i < nfiles; i++) {
+		memset(&w, 0, sizeof(w));
+		if ((fp = fopen(files[i], "rb")) == NULL
+		    || fseek(fp, 0, SEEK_END) < 0 || (len = ftell(fp)) <= 0
+		    || fseek(fp, 0, SEEK_SET) < 0
+		    || (w.buf = (unsigned char *)malloc(len)) == NULL
+		    || fread(w.buf, 1, len, fp) != (size_t)len) {
+			fprintf(stderr, "acmbench: %s: cannot read\n", files[i]);
+			return 1;
+		}
+		fclose(fp);
+		w.len = len;
+
+		acm = open_mem(&w);
+		cur_samples = acm->total_values;
+		printf("%s  {\"file\": ", i ? ",\n" : "");
+		print_json_str(files[i]);
+		printf(", \"level\": %u, \"rows\": %u, \"samples\": %u, \"bytes\": %ld, ",
+		       acm->info.acm_level, acm->info.acm_rows, cur_samples, len);
+		acm_close(acm);
+
+		bench_stream(&w, res);
+		print_stages(res);
+		printf("}");
+		free(w.buf);
+	}
+	printf("\n]\n}\n");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct gen_writer w;
+	double res[T_COUNT];
+	int c, only_level = -1;
+	unsigned level, i;
+	const char *sep = "";
+
+	while ((c = getopt(argc, argv, "n:r:l:")) != -1) {
+		switch (c) {
+		case 'n':
+			cf_samples = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			cf_reps = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			only_level = atoi(optarg);
+			break;
+		default:
+			usage();
+		}
+	}
+	if (cf_samples < 1 || cf_reps < 1 || only_level > 15)
+		usage();
+	if (optind < argc)
+		return bench_files(argv + optind, argc - optind);
+	cur_samples = cf_samples;
+
+	printf("{\n\"version\": \"%s\",\n\"samples\": %u,\n\"reps\": %u,\n",
+	       LIBACM_VERSION, cf_samples, cf_reps);
+
+	printf("\"levels\": [\n");
+	for (level = 0; level < 16; level++) {
+		if (only_level >= 0 && level != (unsigned)only_level)
+			continue;
+		gen_stream(&w, level, level_rows(level), cf_samples, 1, -1);
+		bench_stream(&w, res);
+		printf("%s  {\"level\": %u, \"rows\": %u, \"bytes\": %lu, ",
+		       sep, level, level_rows(level), (unsigned long)w.len);
+		print_stages(res);
+		printf("}");
+		sep = ",\n";
+		free(w.buf);
+	}
+
+	printf("\n],\n\"fillers\": [\n");
+	sep = "";
+	for (i = 0; i < gen_num_fillers; i++) {
+		gen_stream(&w, FILLER_LEVEL, level_rows(FILLER_LEVEL), cf_samples, 1,
+			   gen_valid_fillers[i]);
+		bench_stream(&w, res);
+		printf("%s  {\"filler\": %u, \"name\": \"%s\", \"level\": %u, ",
+		       sep, gen_valid_fillers[i], filler_name(gen_valid_fillers[i]),
+		       FILLER_LEVEL);
+		print_stages(res);
+		printf("}");
+		sep = ",\n";
+		free(w.buf);
+	}
+
+	gen_stream(&w, FILLER_LEVEL, level_rows(FILLER_LEVEL), cf_samples, 1, -1);
+	printf("\n],\n\"seek\": {\"level\": %u, \"count\": %u, "
+	       "\"usec\": %.1f, \"indexed_usec\": %.1f, "
+	       "\"first_usec\": %.1f, \"indexed_first_usec\": %.1f},\n",
+	       FILLER_LEVEL, SEEK_COUNT, bench_seek(&w, 0, 0), bench_seek(&w, 1, 0),
+	       bench_seek(&w, 0, 1), bench_seek(&w, 1, 1));
+	printf("\"open\": {\"count\": %u, \"usec\": %.2f}\n}\n",
+	       OPEN_COUNT, bench_open(&w));
+	free(w.buf);
+	return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Fuzz target for libacm decoder.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Input is an ACM or WAVC file, opened through memory io callbacks
+ * with ACMOptions limits, then read, seeked and verified.
+ *
+ * libFuzzer, with libacm built for it:
+ *
+ *   ./configure CC=clang CFLAGS="-g -O1 -fsanitize=address,fuzzer-no-link"
+ *   make -C src acmfuzz CPPFLAGS=-DACM_LIBFUZZER LDFLAGS=-fsanitize=fuzzer
+ *   src/acmfuzz -max_len=65536 corpus src/acmfuzz-corpus
+ *
+ * Without ACM_LIBFUZZER, main() runs each file given, or stdin,
+ * so AFL can drive it:
+ *
+ *   ./configure CC=afl-clang-fast && make
+ *   afl-fuzz -i src/acmfuzz-corpus -o findings src/acmfuzz @@
+ *
+ * The seed corpus is made of small generated files: levels 0-12,
+ * mono and stereo, all valid fillers, one WAVC and one truncated.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+
+/* limits as a player would set for untrusted files */
+#define FUZZ_BLOCK_MEM		(1 << 20)
+#define FUZZ_VALUES_PER_BYTE	256
+
+/* decoded bytes read at most, before and after seek */
+#define FUZZ_READ_MAX		(1 << 20)
+
+struct mem_file {
+	const unsigned char *data;
+	unsigned len, pos;
+};
+
+static int mem_read(void *dst, int size, int n, void *arg)
+{
+	struct mem_file *f = (struct mem_file *)arg;
+	unsigned len = size * n;
+	if (len > f->len - f->pos)
+		len = f->len - f->pos;
+	memcpy(dst, f->data + f->pos, len);
+	f->pos += len;
+	return len;
+}
+
+static int mem_seek(void *arg, int ofs, int whence)
+{
+	struct mem_file *f = (struct mem_file *)arg;
+	if (whence == SEEK_CUR)
+		ofs += f->pos;
+	else if (whence == SEEK_END)
+		ofs += f->len;
+	if (ofs < 0 || (unsigned)ofs > f->len)
+		return -1;
+	f->pos = ofs;
+	return 0;
+}
+
+static int mem_length(void *arg)
+{
+	return ((struct mem_file *)arg)->len;
+}
+
+static void read_some(ACMStream *acm, unsigned char *buf, unsigned buflen)
+{
+	unsigned total = 0;
+	int res;
+
+	while (total < FUZZ_READ_MAX) {
+		res = acm_read(acm, buf, buflen, 0, 2, 1);
+		if (res <= 0)
+			break;
+		total += res;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static const acm_io_callbacks cb = {
+		mem_read, mem_seek, NULL, mem_length
+	};
+	static unsigned char buf[4096];
+	ACMOptions opts;
+	ACMVerifyReport rep;
+	ACMStream *acm;
+	struct mem_file f;
+	unsigned total;
+
+	if (size > 0x7FFFFFFF)
+		return 0;
+	f.data = data;
+	f.len = size;
+	f.pos = 0;
+	memset(&opts, 0, sizeof(opts));
+	opts.max_block_mem = FUZZ_BLOCK_MEM;
+	opts.max_values_per_byte = FUZZ_VALUES_PER_BYTE;
+	if (acm_open_decoder_ex(&acm, &f, cb, 0, &opts) < 0)
+		return 0;
+
+	/* odd read length, so reads end inside frames and blocks */
+	read_some(acm, buf, sizeof(buf) - 6);
+
+	total = acm_pcm_total(acm);
+	if (total > 0) {
+		acm_seek_pcm(acm, total / 3);
+		read_some(acm, buf, sizeof(buf));
+		acm_seek_pcm(acm, size % total);
+		read_some(acm, buf, 100);
+	}
+	acm_verify(acm, &rep);
+	acm_close(acm);
+	return 0;
+}
+
+#ifndef ACM_LIBFUZZER
+
+static int run_file(FILE *fp)
+{
+	unsigned char *data = NULL, *tmp;
+	size_t len = 0, max = 0, got;
+
+	while (1) {
+		if (len == max) {
+			max = max ? max * 2 : 64 * 1024;
+			tmp = (unsigned char *)realloc(data, max);
+			if (!tmp) {
+				free(data);
+				return -1;
+			}
+			data = tmp;
+		}
+		got = fread(data + len, 1, max - len, fp);
+		if (got == 0)
+			break;
+		len += got;
+	}
+	if (ferror(fp)) {
+		free(data);
+		return -1;
+	}
+	LLVMFuzzerTestOneInput(data, len);
+	free(data);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *fp;
+	int i;
+
+	if (argc < 2)
+		return run_file(stdin) < 0 ? 1 : 0;
+	for (i = 1; i < argc; i++) {
+		fp = fopen(argv[i], "rb");
+		if (!fp) {
+			perror(argv[i]);
+			return 1;
+		}
+		if (run_file(fp) < 0) {
+			fprintf(stderr, "%s: read failed\n", argv[i]);
+			fclose(fp);
+			return 1;
+		}
+		fclose(fp);
+	}
+	return 0;
+}
+
+#endif /* !ACM_LIBFUZZER */
@@ -22,55 +22,84 @@
 #endif
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "libacm.h"
+#include "acm_internal.h"
 
 static int cf_raw = 0;
 /* static int cf_force_chans = 0; */
 static int cf_no_output = 0;
 static int cf_quiet = 0;
+static int cf_verbose = 0;
 
-/* error strings */
-static const char *_errlist[] = {
-	"No error",
-	"ACM error",
-	"Cannot open file",
-	"Not an ACM file",
-	"Read error",
-	"Bad format",
-	"Corrupt file",
-	"Unexcpected EOF",
-	"Stream not seekable"
-};
-
+/* error strings live in util.c */
 const char * libacm_strerror(int err)
 {
-	int nerr = sizeof(_errlist) / sizeof(char *);
-	if ((-err) < 0 || (-err) >= nerr)
-		return "Unknown error";
-	return _errlist[-err];
+	return acm_strerror(err);
 }
 
-static void show_header(const char *fn, ACMStream *acm)
+static void print_header(const char *fn, const ACMInfo *inf,
+			 unsigned total_values, unsigned raw_len)
 {
 	int kbps;
-	const ACMInfo *inf;
 	unsigned m, s, tmp;
 	if (cf_quiet)
 		return;
-	inf = acm_info(acm);
-	kbps = acm_bitrate(acm) / 1000;
-	tmp = acm_time_total(acm) / 1000;
+	kbps = acm_probe_bitrate(inf, total_values, raw_len) / 1000;
+	tmp = acm_probe_time(inf, total_values) / 1000;
 	s = tmp % 60;
 	m = tmp / 60;
 	printf("%s: Length:%2d:%02d Chans:%d(%d) Freq:%d A:%d/%d kbps:%d\n",
-			fn, m, s, acm_channels(acm), acm->info.acm_channels,
-			acm_rate(acm), inf->acm_level, inf->acm_rows, kbps);
+			fn, m, s, inf->channels, inf->acm_channels,
+			inf->rate, inf->acm_level, inf->acm_rows, kbps);
+}
+
+static void show_header(const char *fn, ACMStream *acm)
+{
+	print_header(fn, acm_info(acm), acm->total_values, acm_raw_total(acm));
+}
+
+void libacm_set_verbose(int verbose)
+{
+	cf_verbose = verbose;
+}
+
+/* decoder counters, with --enable-stats */
+static void show_stats(const char *fn, ACMStream *acm)
+{
+	struct acm_stats st;
+	char hist[32 * 16], *p = hist;
+	unsigned i;
+
+	if (!cf_verbose)
+		return;
+	if (acm_get_stats(acm, &st) == ACM_ERR_NOT_SUPPORTED) {
+		fprintf(stderr, "%s: no stats, build with --enable-stats\n", fn);
+		return;
+	}
+
+	hist[0] = 0;
+	for (i = 0; i < 32; i++) {
+		if (st.fillers[i] > 0)
+			p += sprintf(p, " %u:%u", i, st.fillers[i]);
+	}
+	fprintf(stderr, "%s: read %llu bytes in %u loads, %u blocks\n"
+		"%s: fill %.3f ms, juggle %.3f ms, output %.3f ms\n"
+		"%s: seeks %u forward, %u rewind, %llu words dropped, %u blocks skipped\n"
+		"%s: fillers%s\n",
+		fn, (unsigned long long)st.bytes_read, st.load_calls, st.blocks,
+		fn, st.fill_ns / 1e6, st.juggle_ns / 1e6, st.output_ns / 1e6,
+		fn, st.seek_forward, st.seek_rewind,
+		(unsigned long long)st.seek_words, st.seek_skipped,
+		fn, hist);
 }
 
 #ifdef HAVE_AO
@@ -116,10 +145,12 @@ static void close_audio(void)
 static void play_file(const char *fn)
 {
 	ACMStream *acm;
+	acm_ring *ring;
 	int err, res, buflen;
 	ao_sample_format fmt;
 	ao_device *dev;
 	char *buf;
+	const void *data;
 	unsigned int total_bytes, bytes_done = 0;
 
 	err = acm_open_file(&acm, fn, cf_force_chans);
@@ -138,14 +169,24 @@ static void play_file(const char *fn)
 	buflen = 4*1024;
 	buf = malloc(buflen);
 
+	/* decode in another thread, play straight from its buffers */
+	ring = acm_ring_new(acm, 0, 0);
+	if (ring == NULL) {
+		fprintf(stderr, "%s: %s\n", fn, acm_strerror(ACM_ERR_OTHER));
+		goto out;
+	}
+
 	total_bytes = acm_pcm_total(acm) * acm_channels(acm) * ACM_WORD;
 	while (bytes_done < total_bytes) {
-		res = acm_read_loop(acm, buf, buflen/ACM_WORD, 0,2,1);
+		res = acm_ring_peek(ring, &data);
 		if (res == 0)
 			break;
 		if (res > 0) {
+			if ((unsigned)res > total_bytes - bytes_done)
+				res = total_bytes - bytes_done;
 			bytes_done += res;
-			res = ao_play(dev, buf, res);
+			ao_play(dev, (char *)data, res);
+			acm_ring_consume(ring, res);
 		} else {
 			fprintf(stderr, "%s: %s\n", fn, acm_strerror(res));
 			break;
@@ -169,6 +210,9 @@ static void play_file(const char *fn)
 		bytes_done += res;
 	}
 
+	acm_ring_free(ring);
+	show_stats(fn, acm);
+out:
 	acm_close(acm);
 	free(buf);
 }
@@ -259,14 +303,75 @@ static int write_wav_header(void *f, ACMStream *acm, uint8_t mode) {
 	return 0;
 }
 
+/*
+ * Decode rest of stream straight into dst, pad to total_bytes
+ * with one memset.  Returns bytes decoded, without padding.
+ */
+static unsigned decode_into(ACMStream *acm, const char *fn,
+			    unsigned char *dst, unsigned total_bytes)
+{
+	int res;
+
+	res = acm_read_loop(acm, dst, total_bytes, 0,2,1);
+	if (res < 0) {
+		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(res));
+		res = 0;
+	}
+	if ((unsigned)res < total_bytes) {
+		fprintf(stderr, "%s: adding filler_samples: %d\n",
+			fn, total_bytes - res);
+		memset(dst + res, 0, total_bytes - res);
+	}
+	return res;
+}
+
+static unsigned wav_size(ACMStream *acm)
+{
+	return 44 + acm_pcm_total(acm) * acm_channels(acm) * ACM_WORD;
+}
+
+/* size of WAV file for fn, to size libacm_decode_to_buf() output; 0 on error */
+unsigned libacm_wav_size(const char *fn, int cf_force_chans)
+{
+	ACMInfo inf;
+	unsigned total, chans;
+
+	if (acm_probe_file(fn, &inf, &total, NULL) < 0)
+		return 0;
+	chans = cf_force_chans > 0 ? (unsigned)cf_force_chans : inf.channels;
+	return 44 + total / chans * chans * ACM_WORD;
+}
+
+/*
+ * Decode fn as WAV into caller buffer, eg. mmap()ed output file
+ * of libacm_wav_size() bytes.  Returns bytes written or -1.
+ */
+int libacm_decode_to_buf(const char *fn, void *dst, unsigned len, int cf_force_chans)
+{
+	ACMStream *acm;
+	unsigned size;
+	int err;
+
+	if ((err = acm_open_file(&acm, fn, cf_force_chans)) < 0) {
+		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(err));
+		return -1;
+	}
+	size = wav_size(acm);
+	if (len < size) {
+		fprintf(stderr, "%s: output buffer too small\n", fn);
+		acm_close(acm);
+		return -1;
+	}
+	write_wav_header(dst, acm, 1);
+	decode_into(acm, fn, (unsigned char *)dst + 44, size - 44);
+	acm_close(acm);
+	return size;
+}
+
 char * libacm_decode_file_to_mem(const char *fn, uint8_t cf_force_chans, uint32_t * wavsize) {
 	ACMStream *acm;
-	char * buf;
-	int res, buflen, err;
-	char * res2;
 	char * result = NULL;
-	int bytes_done = 0, total_bytes;
-	int bs;
+	int err;
 
 	if(252 & cf_force_chans || cf_force_chans == 3) {
 		fputs("Incorrect channel forcing\n",stderr);
@@ -277,71 +382,152 @@ char * libacm_decode_file_to_mem(const char *fn, uint8_t cf_force_chans, uint32_
 		fprintf(stderr,"%s: %s\n",fn,libacm_strerror(err));
 		return result;
 	}
-	*wavsize = acm_pcm_total(acm);
-	if(cf_force_chans)
-		*wavsize <<= cf_force_chans;
-	else
-		*wavsize <<= acm->info.acm_channels;
-	*wavsize += 44; /* WAV header */
+	*wavsize = wav_size(acm);
 	result = (char*)malloc(*wavsize);
-	if((err = write_wav_header(result,acm,1)) < 0) {
+	if (result == NULL) {
+		fprintf(stderr, "%s: out of memory\n", fn);
 		acm_close(acm);
-		fputs("couldn't write to buffer",stderr);
 		return result;
 	}
+	write_wav_header(result,acm,1);
 	puts("Put in the header");
-	buflen = 16384;
-	buf = (char*)malloc(buflen);
 
-	total_bytes = *wavsize - 44;
+	decode_into(acm, fn, (unsigned char *)result + 44, *wavsize - 44);
+	acm_close(acm);
+	return result;
+}
+
+/*
+ * WAV writer thread.  Decoder fills one buffer while the other is
+ * written.  Without thread, buffers are written in place.  Without
+ * output there is one small buffer for both and no thread.
+ */
 
-	while(bytes_done < total_bytes) {
-		res = acm_read_loop(acm,buf,8192,0,2,1); /* 8192 is half the buflen */
-		if(!res)
-			break;
-		if(res > 0) {
-			res2 = memcpy(result+44+bytes_done,buf,res);
-			if(res2 != result+44+bytes_done) {
-				fputs("buffer write error past wav header",stderr);
-				break;
-			}
-			bytes_done += res;
-		} else {
-			fprintf(stderr,"%s: %s\n",fn,libacm_strerror(res));
+#define WAV_BUFLEN	(4 * 1024 * 1024)
+#define NULL_BUFLEN	(64 * 1024)
+
+struct wav_writer {
+	FILE *f;			/* NULL for no output */
+	unsigned char *buf[2];
+	acm_mutex *lock;
+	acm_cond *cond;
+	acm_thread *thread;
+	int pending;			/* buffer queued for write, or -1 */
+	int writing;			/* buffer being written, or -1 */
+	unsigned pending_len;
+	int quit, err;
+};
+
+static void writer_main(void *arg)
+{
+	struct wav_writer *w = (struct wav_writer *)arg;
+	unsigned len;
+	int idx, fail;
+
+	acm_mutex_lock(w->lock);
+	while (1) {
+		while (w->pending < 0 && !w->quit)
+			acm_cond_wait(w->cond, w->lock);
+		if (w->pending < 0)
 			break;
-		}
+		idx = w->pending;
+		len = w->pending_len;
+		w->pending = -1;
+		w->writing = idx;
+		acm_cond_broadcast(w->cond);
+		acm_mutex_unlock(w->lock);
+
+		fail = fwrite(w->buf[idx], 1, len, w->f) != len;
+
+		acm_mutex_lock(w->lock);
+		if (fail)
+			w->err = 1;
+		w->writing = -1;
+		acm_cond_broadcast(w->cond);
 	}
+	acm_mutex_unlock(w->lock);
+}
 
-	memset(buf,0,buflen);
-	if(bytes_done < total_bytes)
-		fprintf(stderr,"%s: adding filler_samples: %d\n",
-			fn,total_bytes-bytes_done);
-	while(bytes_done < total_bytes) {
-		if(bytes_done + buflen > total_bytes) {
-			bs = total_bytes-bytes_done;
-		} else {
-			bs = buflen;
-		}
-		res2 = memcpy(result+44+bytes_done,buf,bs);
-		if(res2 != result+44+bytes_done)
-			break;
-		bytes_done += bs;
+static int writer_start(struct wav_writer *w, FILE *f, unsigned buflen)
+{
+	memset(w, 0, sizeof(*w));
+	w->f = f;
+	w->pending = w->writing = -1;
+	w->buf[0] = (unsigned char *)malloc(buflen);
+	if (f == NULL) {
+		w->buf[1] = w->buf[0];
+		return w->buf[0] ? 0 : -1;
 	}
+	w->buf[1] = (unsigned char *)malloc(buflen);
+	if (!w->buf[0] || !w->buf[1])
+		return -1;
+	w->lock = acm_mutex_new();
+	w->cond = acm_cond_new();
+	if (w->lock && w->cond)
+		w->thread = acm_thread_start(writer_main, w);
+	return 0;
+}
 
-	acm_close(acm);
-	return result;
+/* wait until buffer idx can be filled */
+static void writer_get(struct wav_writer *w, int idx)
+{
+	if (!w->thread)
+		return;
+	acm_mutex_lock(w->lock);
+	while (w->pending == idx || w->writing == idx)
+		acm_cond_wait(w->cond, w->lock);
+	acm_mutex_unlock(w->lock);
 }
 
-void libacm_decode_file(const char *fn, const char *fn2, int cf_force_chans) {
+static void writer_put(struct wav_writer *w, int idx, unsigned len)
+{
+	if (w->f == NULL)
+		return;
+	if (!w->thread) {
+		if (fwrite(w->buf[idx], 1, len, w->f) != len)
+			w->err = 1;
+		return;
+	}
+	acm_mutex_lock(w->lock);
+	while (w->pending >= 0)
+		acm_cond_wait(w->cond, w->lock);
+	w->pending = idx;
+	w->pending_len = len;
+	acm_cond_broadcast(w->cond);
+	acm_mutex_unlock(w->lock);
+}
+
+/* flush and stop, returns -1 on write error */
+static int writer_finish(struct wav_writer *w)
+{
+	if (w->thread) {
+		acm_mutex_lock(w->lock);
+		w->quit = 1;
+		acm_cond_broadcast(w->cond);
+		acm_mutex_unlock(w->lock);
+		acm_thread_join(w->thread);
+	}
+	if (w->cond)
+		acm_cond_free(w->cond);
+	if (w->lock)
+		acm_mutex_free(w->lock);
+	if (w->buf[1] != w->buf[0])
+		free(w->buf[1]);
+	free(w->buf[0]);
+	return w->err ? -1 : 0;
+}
+
+/* returns PCM bytes written, or -1 */
+static int decode_one(const char *fn, const char *fn2, int cf_force_chans) {
 	ACMStream *acm;
-	char *buf;
-	int res, res2, buflen, err;
+	struct wav_writer w;
+	unsigned buflen, fill = 0, want, total_bytes, bytes_done = 0;
+	int res, err, cur = 0, zeroed[2] = { 0, 0 };
 	FILE *fo = NULL;
-	int bytes_done = 0, total_bytes;
 
 	if ((err = acm_open_file(&acm,fn,cf_force_chans)) < 0) {
 		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(err));
-		return;
+		return -1;
 	}
 
 	if (!cf_no_output) {
@@ -354,67 +540,362 @@ void libacm_decode_file(const char *fn, const char *fn2, int cf_force_chans) {
 		if (fo == NULL) {
 			perror(fn2);
 			acm_close(acm);
-			return;
+			return -1;
 		}
 	}
 
 	show_header(fn, acm);
 
-	if ((!cf_raw) && (!cf_no_output)) {
-		if ((err = write_wav_header(fo, acm,0)) < 0) {
-			perror(fn2);
+	total_bytes = acm_pcm_total(acm) * acm_channels(acm) * ACM_WORD;
+	buflen = cf_no_output ? NULL_BUFLEN : WAV_BUFLEN;
+	if (total_bytes + 44 < buflen)
+		buflen = total_bytes + 44;
+	if (writer_start(&w, fo, buflen) < 0) {
+		fprintf(stderr, "%s: out of memory\n", fn);
+		writer_finish(&w);
+		if (fo)
 			fclose(fo);
-			acm_close(acm);
-			return;
-		}
+		acm_close(acm);
+		return -1;
+	}
+
+	/* header goes with the data, in one stream of writes */
+	if ((!cf_raw) && (!cf_no_output)) {
+		write_wav_header(w.buf[0], acm, 1);
+		fill = 44;
 	}
-	buflen = 16384;
-	buf = (char*)malloc(buflen);
 
-	total_bytes = acm_pcm_total(acm) * acm_channels(acm) * ACM_WORD;
-	
 	while (bytes_done < total_bytes) {
-		res = acm_read_loop(acm, buf, buflen/2, 0,2,1);
-		if (!res)
-			break;
-		if (res > 0) {
-			if (!cf_no_output) {
-				res2 = fwrite(buf, 1, res, fo);
-				if (res2 != res) {
-					fprintf(stderr, "%s: write error\n", fn2);
-					break;
-				}
-			}
-			bytes_done += res;
-		} else {
-			fprintf(stderr, "%s: %s\n", fn, libacm_strerror(res));
+		want = buflen - fill;
+		if (want > total_bytes - bytes_done)
+			want = total_bytes - bytes_done;
+		res = acm_read_loop(acm, w.buf[cur] + fill, want, 0,2,1);
+		if (res <= 0) {
+			if (res < 0)
+				fprintf(stderr, "%s: %s\n", fn, libacm_strerror(res));
 			break;
 		}
+		fill += res;
+		bytes_done += res;
+		if (fill == buflen) {
+			writer_put(&w, cur, fill);
+			cur ^= 1;
+			writer_get(&w, cur);
+			fill = 0;
+		}
 	}
 
-	memset(buf, 0, buflen);
+	/* each buffer is zeroed at most once */
 	if (bytes_done < total_bytes)
 		fprintf(stderr, "%s: adding filler_samples: %d\n",
 			fn, total_bytes - bytes_done);
 	while (bytes_done < total_bytes) {
-		int bs;
-		if (bytes_done + buflen > total_bytes) {
-			bs = total_bytes - bytes_done;
+		want = buflen - fill;
+		if (want > total_bytes - bytes_done)
+			want = total_bytes - bytes_done;
+		if (fill > 0) {
+			memset(w.buf[cur] + fill, 0, want);
+		} else if (!zeroed[cur]) {
+			memset(w.buf[cur], 0, buflen);
+			zeroed[cur] = 1;
+		}
+		fill += want;
+		bytes_done += want;
+		if (fill == buflen) {
+			writer_put(&w, cur, fill);
+			cur ^= 1;
+			writer_get(&w, cur);
+			fill = 0;
+		}
+	}
+	if (fill > 0)
+		writer_put(&w, cur, fill);
+
+	err = writer_finish(&w);
+	show_stats(fn, acm);
+	acm_close(acm);
+	if (!cf_no_output && fclose(fo) != 0)
+		err = -1;
+	if (err < 0) {
+		fprintf(stderr, "%s: write error\n", fn2);
+		return -1;
+	}
+	return bytes_done;
+}
+
+void libacm_decode_file(const char *fn, const char *fn2, int cf_force_chans) {
+	decode_one(fn, fn2, cf_force_chans);
+}
+
+/*
+ * Batch decode.  Each worker has own queue of files, biggest first.
+ * Idle worker steals from the other end of someone else's queue,
+ * so small files move and big ones stay where they started.
+ */
+
+struct batch_job {
+	const char *fn;
+	char *fn2;
+	long size;
+};
+
+struct batch_queue {
+	acm_mutex *lock;
+	struct batch_job **jobs;
+	unsigned head, tail;
+};
+
+struct batch {
+	struct batch_queue *queues;
+	unsigned nqueues;
+	int cf_force_chans;
+	acm_mutex *lock;		/* for totals */
+	unsigned files_ok, files_failed;
+	double pcm_bytes;
+};
+
+struct batch_worker {
+	struct batch *b;
+	unsigned id;
+};
+
+static struct batch_job *batch_take(struct batch *b, unsigned id)
+{
+	struct batch_queue *q;
+	struct batch_job *job = NULL;
+	unsigned i;
+
+	/* own queue from front */
+	q = &b->queues[id];
+	acm_mutex_lock(q->lock);
+	if (q->head < q->tail)
+		job = q->jobs[q->head++];
+	acm_mutex_unlock(q->lock);
+
+	/* steal from back */
+	for (i = 1; job == NULL && i < b->nqueues; i++) {
+		q = &b->queues[(id + i) % b->nqueues];
+		acm_mutex_lock(q->lock);
+		if (q->head < q->tail)
+			job = q->jobs[--q->tail];
+		acm_mutex_unlock(q->lock);
+	}
+	return job;
+}
+
+static void batch_run(void *arg)
+{
+	struct batch_worker *w = (struct batch_worker *)arg;
+	struct batch *b = w->b;
+	struct batch_job *job;
+	int res;
+
+	while ((job = batch_take(b, w->id)) != NULL) {
+		res = decode_one(job->fn, job->fn2, b->cf_force_chans);
+		acm_mutex_lock(b->lock);
+		if (res < 0) {
+			b->files_failed++;
 		} else {
-			bs = buflen;
+			b->files_ok++;
+			b->pcm_bytes += res;
+		}
+		acm_mutex_unlock(b->lock);
+	}
+}
+
+static int has_acm_ext(const char *fn)
+{
+	const char *p = strrchr(fn, '.');
+	return p != NULL && (!strcmp(p, ".acm") || !strcmp(p, ".ACM"));
+}
+
+static int add_job(struct batch_job **jobs, unsigned *n, unsigned *max,
+		   const char *fn)
+{
+	struct batch_job *job;
+	struct stat st;
+
+	if (*n == *max) {
+		unsigned nmax = *max ? *max * 2 : 64;
+		void *tmp = realloc(*jobs, nmax * sizeof(**jobs));
+		if (!tmp)
+			return -1;
+		*jobs = (struct batch_job *)tmp;
+		*max = nmax;
+	}
+	job = &(*jobs)[*n];
+	job->fn = strdup(fn);
+	job->fn2 = libacm_makefn(fn, ".wav");
+	if (!job->fn || !job->fn2) {
+		free((char *)job->fn);
+		free(job->fn2);
+		return -1;
+	}
+	job->size = stat(fn, &st) == 0 ? (long)st.st_size : 0;
+	/* WAVC files may already have .wav extension */
+	if (!strcmp(job->fn, job->fn2)) {
+		fprintf(stderr, "%s: output would overwrite input\n", fn);
+		free((char *)job->fn);
+		free(job->fn2);
+		return 0;
+	}
+	(*n)++;
+	return 0;
+}
+
+/* directories are expanded to *.acm files in them */
+static int collect_jobs(const char **inputs, unsigned ninputs,
+			struct batch_job **jobs, unsigned *n)
+{
+	unsigned i, max = 0;
+	struct stat st;
+	struct dirent *de;
+	DIR *dir;
+	char *path;
+
+	*jobs = NULL;
+	*n = 0;
+	for (i = 0; i < ninputs; i++) {
+		if (stat(inputs[i], &st) != 0 || !S_ISDIR(st.st_mode)) {
+			if (add_job(jobs, n, &max, inputs[i]) < 0)
+				return -1;
+			continue;
 		}
-		if (!cf_no_output) {
-			res2 = fwrite(buf, 1, bs, fo);
-			if (res2 != bs)
+		if ((dir = opendir(inputs[i])) == NULL) {
+			perror(inputs[i]);
+			continue;
+		}
+		while ((de = readdir(dir)) != NULL) {
+			if (!has_acm_ext(de->d_name))
+				continue;
+			path = (char *)malloc(strlen(inputs[i]) + strlen(de->d_name) + 2);
+			if (!path)
 				break;
+			sprintf(path, "%s/%s", inputs[i], de->d_name);
+			if (add_job(jobs, n, &max, path) < 0) {
+				free(path);
+				closedir(dir);
+				return -1;
+			}
+			free(path);
 		}
-		bytes_done += bs;
+		closedir(dir);
 	}
+	return 0;
+}
 
-	acm_close(acm);
-	if (!cf_no_output)
-		fclose(fo);
-	free(buf);
+static int cmp_job_size(const void *a, const void *b)
+{
+	const struct batch_job *ja = (const struct batch_job *)a;
+	const struct batch_job *jb = (const struct batch_job *)b;
+	if (ja->size != jb->size)
+		return ja->size < jb->size ? 1 : -1;
+	return 0;
+}
+
+static double now_sec(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/*
+ * Decode files (or directories of .acm files) to .wav next to them,
+ * with nthreads workers, 0 means one per CPU.
+ */
+void libacm_decode_batch(const char **inputs, unsigned ninputs,
+			 unsigned nthreads, int cf_force_chans)
+{
+	struct batch b;
+	struct batch_job *jobs = NULL;
+	struct batch_worker *workers = NULL;
+	acm_thread **tids = NULL;
+	unsigned i, njobs = 0, started;
+	double t0, t;
+
+	memset(&b, 0, sizeof(b));
+	if (collect_jobs(inputs, ninputs, &jobs, &njobs) < 0) {
+		fputs("out of memory\n", stderr);
+		goto out;
+	}
+	if (njobs == 0)
+		goto out;
+
+	if (nthreads == 0)
+		nthreads = acm_cpu_count();
+	if (nthreads > njobs)
+		nthreads = njobs;
+
+	b.cf_force_chans = cf_force_chans;
+	b.nqueues = nthreads;
+	b.queues = (struct batch_queue *)calloc(nthreads, sizeof(*b.queues));
+	b.lock = acm_mutex_new();
+	workers = (struct batch_worker *)calloc(nthreads, sizeof(*workers));
+	tids = (acm_thread **)calloc(nthreads, sizeof(*tids));
+	if (!b.queues || !b.lock || !workers || !tids) {
+		fputs("out of memory\n", stderr);
+		goto out;
+	}
+
+	/* deal biggest files first, round robin */
+	qsort(jobs, njobs, sizeof(*jobs), cmp_job_size);
+	for (i = 0; i < nthreads; i++) {
+		b.queues[i].lock = acm_mutex_new();
+		b.queues[i].jobs = (struct batch_job **)malloc(
+				(njobs / nthreads + 1) * sizeof(struct batch_job *));
+		if (!b.queues[i].lock || !b.queues[i].jobs) {
+			fputs("out of memory\n", stderr);
+			goto out;
+		}
+	}
+	for (i = 0; i < njobs; i++) {
+		struct batch_queue *q = &b.queues[i % nthreads];
+		q->jobs[q->tail++] = &jobs[i];
+	}
+
+	t0 = now_sec();
+	for (started = 1; started < nthreads; started++) {
+		workers[started].b = &b;
+		workers[started].id = started;
+		tids[started] = acm_thread_start(batch_run, &workers[started]);
+		if (tids[started] == NULL)
+			break;
+	}
+	/* this thread is worker 0, others steal what failed to start */
+	workers[0].b = &b;
+	workers[0].id = 0;
+	batch_run(&workers[0]);
+	for (i = 1; i < started; i++)
+		acm_thread_join(tids[i]);
+	t = now_sec() - t0;
+	if (t <= 0)
+		t = 1e-6;
+
+	if (!cf_quiet)
+		printf("%u files, %u failed, %.2f s: %.1f files/s, %.1f MB/s PCM\n",
+			b.files_ok + b.files_failed, b.files_failed, t,
+			(b.files_ok + b.files_failed) / t,
+			b.pcm_bytes / (1024.0 * 1024.0) / t);
+
+out:
+	if (b.queues) {
+		for (i = 0; i < b.nqueues; i++) {
+			if (b.queues[i].lock)
+				acm_mutex_free(b.queues[i].lock);
+			free(b.queues[i].jobs);
+		}
+		free(b.queues);
+	}
+	if (b.lock)
+		acm_mutex_free(b.lock);
+	free(workers);
+	free(tids);
+	for (i = 0; i < njobs; i++) {
+		free((char *)jobs[i].fn);
+		free(jobs[i].fn2);
+	}
+	free(jobs);
 }
 
 /*
@@ -467,16 +948,70 @@ void libacm_set_channels(const char *fn, int n_chan)
  * Just show info
  */
 
-void libacm_show_info(const char *fn, int cf_force_chans) {
+/* acmtool --index: write seek index sidecar, see idxfile.c */
+void libacm_write_index(const char *fn)
+{
+	ACMStream *acm;
+	char *idxfn;
 	int err;
+
+	err = acm_open_file(&acm, fn, 0);
+	if (err < 0) {
+		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(err));
+		return;
+	}
+	err = acm_save_index(acm, fn);
+	idxfn = acm_index_filename(fn);
+	if (err < 0)
+		fprintf(stderr, "%s: %s\n", idxfn ? idxfn : fn, libacm_strerror(err));
+	else if (cf_verbose)
+		fprintf(stderr, "%s: %u blocks\n", idxfn, acm->seek_idx_len);
+	free(idxfn);
+	acm_close(acm);
+}
+
+/* acmtool --verify: parse without decoding, 0 if file is complete */
+int libacm_verify_file(const char *fn, int cf_force_chans)
+{
+	ACMVerifyReport rep;
 	ACMStream *acm;
+	int err;
 
 	err = acm_open_file(&acm, fn, cf_force_chans);
+	if (err < 0) {
+		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(err));
+		return err;
+	}
+	err = acm_verify(acm, &rep);
+	if (err == ACM_ERR_CORRUPT)
+		fprintf(stderr, "%s: %u corrupt blocks, %u to %u, %u of %u samples\n",
+			fn, rep.bad_blocks, rep.first_bad, rep.last_bad,
+			rep.pcm_valid, rep.pcm_header);
+	else if (err == ACM_ERR_UNEXPECTED_EOF)
+		fprintf(stderr, "%s: data ends at byte %u, %u of %u samples\n",
+			fn, rep.raw_end, rep.pcm_valid, rep.pcm_header);
+	else if (err < 0)
+		fprintf(stderr, "%s: %s\n", fn, libacm_strerror(err));
+	else if (cf_verbose)
+		fprintf(stderr, "%s: ok, %u blocks, %u samples\n",
+			fn, rep.blocks, rep.pcm_valid);
+	acm_close(acm);
+	return err;
+}
+
+void libacm_show_info(const char *fn, int cf_force_chans) {
+	int err;
+	ACMInfo inf;
+	unsigned total, raw_len;
+
+	/* header only, no decoder */
+	err = acm_probe_file(fn, &inf, &total, &raw_len);
 	if (err < 0) {
 		printf("%s: %s\n", fn, libacm_strerror(err));
 		return;
 	}
+	if (cf_force_chans > 0)
+		inf.channels = cf_force_chans;
 
-	show_header(fn, acm);
-	acm_close(acm);
+	print_header(fn, &inf, total, raw_len);
 }
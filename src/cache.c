@@ -0,0 +1,345 @@
+/*
+ * Decoded PCM cache for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Whole files are decoded once and kept as decoded values, 4 bytes
+ * per sample, so every output format stays exact.  acm_open_cached()
+ * gives a stream over them, see acm_open_pcm().
+ *
+ * Entries are keyed by file identity (device, inode, size, mtime)
+ * and force_chans, and kept in LRU order.  An entry dropped while
+ * streams still use it is freed by the last acm_close().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+struct cache_key {
+	uint64_t dev, ino, size, mtime;
+	int force_chans;
+#ifdef _WIN32
+	char *filename;			/* no inodes there */
+#endif
+};
+
+struct cache_entry {
+	struct cache_entry *prev, *next;	/* LRU list, newest first */
+	struct cache_key key;
+	ACMInfo info;
+	unsigned total_values, raw_len;
+	int *values;
+	size_t bytes;
+	unsigned refs;			/* list and open streams */
+};
+
+static int cache_init_done;
+static acm_mutex *cache_lock;		/* NULL if it could not be made */
+static struct cache_entry *cache_head, *cache_tail;
+static size_t cache_budget;
+static struct acm_cache_stats cache_stats;
+
+static int get_key(const char *fn, int force_chans, struct cache_key *key)
+{
+	struct stat st;
+
+	if (stat(fn, &st) != 0)
+		return ACM_ERR_OPEN;
+	memset(key, 0, sizeof(*key));
+	key->dev = st.st_dev;
+	key->ino = st.st_ino;
+	key->size = st.st_size;
+	key->mtime = st.st_mtime;
+	key->force_chans = force_chans;
+#ifdef _WIN32
+	key->filename = (char *)fn;
+#endif
+	return 0;
+}
+
+static int same_key(const struct cache_key *a, const struct cache_key *b)
+{
+	if (a->dev != b->dev || a->ino != b->ino || a->size != b->size
+	    || a->mtime != b->mtime || a->force_chans != b->force_chans)
+		return 0;
+#ifdef _WIN32
+	if (strcmp(a->filename, b->filename) != 0)
+		return 0;
+#endif
+	return 1;
+}
+
+static void free_entry(struct cache_entry *e)
+{
+#ifdef _WIN32
+	free(e->key.filename);
+#endif
+	free(e->values);
+	free(e);
+}
+
+/* lock must be held */
+static void unref(struct cache_entry *e)
+{
+	if (--e->refs == 0)
+		free_entry(e);
+}
+
+static void unlink_entry(struct cache_entry *e)
+{
+	if (e->prev)
+		e->prev->next = e->next;
+	else
+		cache_head = e->next;
+	if (e->next)
+		e->next->prev = e->prev;
+	else
+		cache_tail = e->prev;
+	e->prev = e->next = NULL;
+}
+
+static void push_front(struct cache_entry *e)
+{
+	e->prev = NULL;
+	e->next = cache_head;
+	if (cache_head)
+		cache_head->prev = e;
+	else
+		cache_tail = e;
+	cache_head = e;
+}
+
+/* drop oldest entries until bytes more fit */
+static void evict(size_t bytes)
+{
+	struct cache_entry *e;
+
+	while (cache_tail && cache_stats.bytes + bytes > cache_budget) {
+		e = cache_tail;
+		unlink_entry(e);
+		cache_stats.bytes -= e->bytes;
+		cache_stats.entries--;
+		cache_stats.evictions++;
+		unref(e);
+	}
+}
+
+static struct cache_entry *lookup(const struct cache_key *key)
+{
+	struct cache_entry *e;
+
+	for (e = cache_head; e; e = e->next) {
+		if (same_key(&e->key, key)) {
+			unlink_entry(e);
+			push_front(e);
+			return e;
+		}
+	}
+	return NULL;
+}
+
+static void cache_init(void)
+{
+	cache_lock = acm_mutex_new();
+}
+
+static acm_mutex *get_lock(void)
+{
+	acm_once(&cache_init_done, cache_init);
+	return cache_lock;
+}
+
+/* acm_close() of a view */
+static int release_view(void *arg)
+{
+	acm_mutex_lock(cache_lock);
+	unref((struct cache_entry *)arg);
+	acm_mutex_unlock(cache_lock);
+	return 0;
+}
+
+/* called with reference held */
+static int open_view(ACMStream **res, struct cache_entry *e)
+{
+	int err;
+
+	err = acm_open_pcm(res, e->values, e->total_values, &e->info,
+			   e->raw_len, release_view, e);
+	if (err < 0)
+		release_view(e);
+	return err;
+}
+
+/* decode whole stream, keeps acm open */
+static struct cache_entry *decode_entry(ACMStream *acm, size_t bytes)
+{
+	struct cache_entry *e;
+	const int *src;
+	unsigned got = 0;
+	int res;
+
+	e = (struct cache_entry *)calloc(1, sizeof(*e));
+	if (!e)
+		return NULL;
+	e->values = (int *)malloc(bytes);
+	if (!e->values) {
+		free(e);
+		return NULL;
+	}
+	while ((res = acm_read_block_ptr(acm, &src, acm->total_values - got)) > 0) {
+		memcpy(e->values + got, src, res * sizeof(int));
+		got += res;
+	}
+	/*
+	 * Truncated or corrupt file is not cached, its stream would
+	 * report fewer samples than a plain one.  Last partial frame
+	 * may be missing.
+	 */
+	if (res < 0 || got == 0
+	    || got < acm->total_values - acm->total_values % acm->info.channels) {
+		free_entry(e);
+		return NULL;
+	}
+	e->info = acm->info;
+	e->total_values = got;
+	e->raw_len = acm_raw_total(acm);
+	e->bytes = bytes;
+	return e;
+}
+
+/*
+ * Set cache size in bytes of decoded values, 0 disables it and
+ * drops all entries.  Returns 0 or error code.
+ */
+int acm_cache_set_budget(size_t bytes)
+{
+	if (get_lock() == NULL)
+		return ACM_ERR_OTHER;
+	acm_mutex_lock(cache_lock);
+	cache_budget = bytes;
+	cache_stats.budget = bytes;
+	evict(0);
+	acm_mutex_unlock(cache_lock);
+	return 0;
+}
+
+/* hits, misses and memory of the cache */
+void acm_cache_get_stats(struct acm_cache_stats *st)
+{
+	if (get_lock() == NULL) {
+		memset(st, 0, sizeof(*st));
+		return;
+	}
+	acm_mutex_lock(cache_lock);
+	*st = cache_stats;
+	acm_mutex_unlock(cache_lock);
+}
+
+/*
+ * Like acm_open_file(), but decoded values are shared between
+ * streams of same file.  First open decodes all of it.  Files
+ * bigger than the budget, or that fail to decode fully, are
+ * given as plain streams.
+ */
+int acm_open_cached(ACMStream **res, const char *filename, int force_chans)
+{
+	struct cache_entry *e, *old;
+	struct cache_key key;
+	ACMStream *acm;
+	size_t bytes, budget;
+	int err;
+
+	if (get_lock() == NULL)
+		return acm_open_file(res, filename, force_chans);
+	if ((err = get_key(filename, force_chans, &key)) < 0)
+		return err;
+
+	acm_mutex_lock(cache_lock);
+	budget = cache_budget;
+	if (budget == 0) {
+		acm_mutex_unlock(cache_lock);
+		return acm_open_file(res, filename, force_chans);
+	}
+	e = lookup(&key);
+	if (e) {
+		e->refs++;
+		cache_stats.hits++;
+	} else {
+		cache_stats.misses++;
+	}
+	acm_mutex_unlock(cache_lock);
+	if (e)
+		return open_view(res, e);
+
+	/* decode without lock, other thread may do same */
+	if ((err = acm_open_file(&acm, filename, force_chans)) < 0)
+		return err;
+	bytes = (size_t)acm->total_values * sizeof(int);
+	if (acm->total_values == 0 || bytes / sizeof(int) != acm->total_values
+	    || bytes > budget) {
+		*res = acm;
+		return ACM_OK;
+	}
+	e = decode_entry(acm, bytes);
+	if (e == NULL) {
+		if ((err = acm_rewind(acm)) < 0) {
+			acm_close(acm);
+			return err;
+		}
+		*res = acm;
+		return ACM_OK;
+	}
+	acm_close(acm);
+
+	e->key = key;
+#ifdef _WIN32
+	e->key.filename = strdup(filename);
+	if (e->key.filename == NULL) {
+		free_entry(e);
+		return ACM_ERR_OTHER;
+	}
+#endif
+
+	acm_mutex_lock(cache_lock);
+	old = lookup(&key);
+	if (old) {
+		/* lost the race, use the other copy */
+		free_entry(e);
+		e = old;
+		e->refs++;
+	} else if (e->bytes <= cache_budget) {
+		evict(e->bytes);
+		push_front(e);
+		e->refs = 2;
+		cache_stats.bytes += e->bytes;
+		cache_stats.entries++;
+	} else {
+		/* budget was lowered meanwhile */
+		e->refs = 1;
+	}
+	acm_mutex_unlock(cache_lock);
+	return open_view(res, e);
+}
@@ -26,18 +26,98 @@
 #include <string.h>
 
 #include "libacm.h"
+#include "acm_internal.h"
+#include "filltab.h"
 
 #define ACM_BUFLEN	(64*1024)
 
+/*
+ * Fill through tile of FILL_TILE columns if block has at least
+ * FILL_TILE_WORDS and rows are longer than a cache line.
+ */
+#define FILL_TILE	16
+#define FILL_TILE_WORDS	(16*1024)
+
 #define ACM_EXPECTED_EOF -99
 
-typedef int (*filler_t)(ACMStream *acm, unsigned col);
+typedef int (*filler_t)(ACMStream *acm, unsigned ind);
 
 /**************************************
  * Stream processing
  **************************************/
 
-/* NB: bits <= 31!  Thus less checks in code. */
+/*
+ * Bits are kept in 64-bit accumulator.  Refill loads 8 bytes at once
+ * and takes as many whole bytes as fit, which leaves in the upper bits
+ * either zeroes or next bytes of stream.  As next refill ORs the same
+ * bytes into same place, those need no masking.
+ *
+ * Buffer has ACM_BUF_PAD zero bytes after data, so that the refill
+ * can also load past the end of data.
+ *
+ * NB: bits <= 31!  Thus less checks in code.
+ */
+
+static uint64_t get_le64(const unsigned char *p)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+#else
+	return (uint64_t)p[0] | ((uint64_t)p[1] << 8)
+		| ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24)
+		| ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40)
+		| ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+#endif
+}
+
+/*
+ * Memory backend reads in place.  Window stops ACM_BUF_PAD bytes
+ * before end, so 8-byte loads stay inside; the rest is copied
+ * to zero padded mem_tail.
+ */
+static int load_mem(ACMStream *acm)
+{
+	unsigned ofs, left;
+
+	ofs = acm->buf_start_ofs + acm->buf_size;
+	left = ofs < acm->mem_len ? acm->mem_len - ofs : 0;
+	acm->buf_start_ofs = ofs;
+	acm->buf_pos = 0;
+
+	if (left > ACM_BUF_PAD) {
+		acm->data = acm->mem_data + ofs;
+		acm->buf_size = left - ACM_BUF_PAD;
+		return 0;
+	}
+
+	memset(acm->mem_tail, 0, sizeof(acm->mem_tail));
+	if (left > 0) {
+		memcpy(acm->mem_tail, acm->mem_data + ofs, left);
+		acm->buf_size = left;
+	} else {
+		/* single zero byte, as in load_buf() */
+		acm->file_eof = 1;
+		acm->buf_size = 1;
+	}
+	acm->data = acm->mem_tail;
+	return 0;
+}
+
+/*
+ * Push mode keeps all unread bytes in buf, acm_feed() appends
+ * to it.  Nothing to load until more is fed; after end of input
+ * single zero byte is added, as in load_buf().
+ */
+static int load_push(ACMStream *acm)
+{
+	if (acm->push_eof) {
+		acm->file_eof = 1;
+		acm->buf[acm->buf_size++] = 0;
+	}
+	return 0;
+}
 
 static int load_buf(ACMStream *acm)
 {
@@ -45,6 +125,10 @@ static int load_buf(ACMStream *acm)
 
 	if (acm->file_eof)
 		return 0;
+	if (acm->mem_data != NULL)
+		return load_mem(acm);
+	if (acm->push_mode)
+		return load_push(acm);
 
 	acm->buf_start_ofs += acm->buf_size;
 
@@ -52,8 +136,10 @@ static int load_buf(ACMStream *acm)
 		res = acm->io.read_func(acm->buf, 1, acm->buf_max,
 				acm->io_arg);
 
+	ACM_STAT(acm, load_calls++);
 	if (res < 0)
 		return ACM_ERR_READ_ERR;
+	ACM_STAT(acm, bytes_read += res);
 
 	if (res == 0) {
 		acm->file_eof = 1;
@@ -63,75 +149,61 @@ static int load_buf(ACMStream *acm)
 	} else {
 		acm->buf_size = res;
 	}
+	memset(acm->buf + acm->buf_size, 0, ACM_BUF_PAD);
+	acm->data = acm->buf;
 	acm->buf_pos = 0;
 	return 0;
 }
 
+/* slow refill, near the end of buffer */
 static int load_bits(ACMStream *acm)
 {
 	int err;
-	unsigned data, got;
-	unsigned char *p = acm->buf + acm->buf_pos;
-	switch (acm->buf_size - acm->buf_pos) {
-	default:
-		data = 0;
-		got = 0;
-		break;
-	case 1:
-		data = p[0];
-		got = 8;
-		break;
-	case 2:
-		data = p[0] + (p[1] << 8);
-		got = 16;
-		break;
-	case 3:
-		data = p[0] + (p[1] << 8) + (p[2] << 16);
-		got = 24;
-		break;
-	}
-	
-	if ((err = load_buf(acm)) < 0)
-		return err;
-	
-	while (got < 32) {
-		if (acm->buf_size - acm->buf_pos == 0)
-			break;
-		data |= acm->buf[acm->buf_pos] << got;
-		got += 8;
-		acm->buf_pos++;
+	unsigned got, left;
+
+	while (acm->bit_avail < 56) {
+		left = acm->buf_size - acm->buf_pos;
+		if (left == 0) {
+			if ((err = load_buf(acm)) < 0)
+				return err;
+			left = acm->buf_size - acm->buf_pos;
+			if (left == 0)
+				break;
+		}
+		got = (63 - acm->bit_avail) >> 3;
+		if (got > left)
+			got = left;
+		acm->bit_data |= get_le64(acm->data + acm->buf_pos) << acm->bit_avail;
+		acm->buf_pos += got;
+		acm->bit_avail += got * 8;
 	}
-	acm->bit_data = data;
-	acm->bit_avail = got;
 	return 0;
 }
 
+/* fill accumulator up to at least 56 bits, unless near EOF */
+static int refill_bits(ACMStream *acm)
+{
+	if (acm->buf_size - acm->buf_pos >= 8) {
+		acm->bit_data |= get_le64(acm->data + acm->buf_pos) << acm->bit_avail;
+		acm->buf_pos += (63 - acm->bit_avail) >> 3;
+		acm->bit_avail |= 56;
+		return 0;
+	}
+	return load_bits(acm);
+}
+
 static int get_bits_reload(ACMStream *acm, unsigned bits)
 {
-	int got, err;
-	unsigned data, b_data, b_avail;
+	int data, err;
 
-	data = acm->bit_data;
-	got = acm->bit_avail;
-	bits -= got;
+	if ((err = refill_bits(acm)) < 0)
+		return err;
+	if (acm->bit_avail < bits)
+		return ACM_ERR_UNEXPECTED_EOF;
 
-	if (acm->buf_size - acm->buf_pos >= 4) {
-		unsigned char *p = acm->buf + acm->buf_pos;
-		acm->buf_pos += 4;
-		b_data = p[0] + (p[1] << 8) + (p[2] << 16) + (p[3] << 24);
-		b_avail = 32;
-	} else	{
-		if ((err = load_bits(acm)) < 0)
-			return err;
-		if (acm->bit_avail < bits)
-			return ACM_ERR_UNEXPECTED_EOF;
-		b_data = acm->bit_data;
-		b_avail = acm->bit_avail;
-	}
-	
-	data |= (b_data & ((1 << bits) - 1)) << got;
-	acm->bit_data = b_data >> bits;
-	acm->bit_avail = b_avail - bits;
+	data = acm->bit_data & ((1 << bits) - 1);
+	acm->bit_data >>= bits;
+	acm->bit_avail -= bits;
 	return data;
 }
 
@@ -163,6 +235,77 @@ static int get_bits_reload(ACMStream *acm, unsigned bits)
 		res = tmpval; \
 	} while (0)
 
+/*
+ * acm_skip_bits() past the accumulator.  Kept out of line, so the
+ * short path does not pay for the registers this one needs.
+ */
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static int skip_bits_reload(ACMStream *acm, unsigned nbits)
+{
+	unsigned n, left;
+	int tmp, err;
+
+	if (nbits <= 56) {
+		if ((err = refill_bits(acm)) < 0)
+			return err;
+		if (nbits <= acm->bit_avail) {
+			acm->bit_data >>= nbits;
+			acm->bit_avail -= nbits;
+			return 0;
+		}
+	}
+
+	if (nbits >= acm->bit_avail + 64) {
+		nbits -= acm->bit_avail;
+		acm->bit_data = 0;
+		acm->bit_avail = 0;
+		for (n = nbits / 8; n > 0; n -= left) {
+			left = acm->buf_size - acm->buf_pos;
+			if (left == 0) {
+				if ((err = load_buf(acm)) < 0)
+					return err;
+				left = acm->buf_size - acm->buf_pos;
+				if (left == 0)
+					return ACM_ERR_UNEXPECTED_EOF;
+			}
+			if (left > n)
+				left = n;
+			acm->buf_pos += left;
+		}
+		nbits %= 8;
+	}
+
+	for (; nbits >= 16; nbits -= 16)
+		GET_BITS(tmp, acm, 16);
+	if (nbits > 0)
+		GET_BITS(tmp, acm, nbits);
+	(void)tmp;
+	return 0;
+}
+
+/*
+ * Drop nbits from stream.  Whole bytes after the accumulator
+ * are stepped over in buffer, without loading them into it.
+ * Returns 0 or error code.
+ */
+int acm_skip_bits(ACMStream *acm, unsigned nbits)
+{
+	if (nbits > acm->bit_avail) {
+		if (nbits > 56 || acm->buf_size - acm->buf_pos < 8)
+			return skip_bits_reload(acm, nbits);
+		/* refill_bits(), without the call */
+		acm->bit_data |= get_le64(acm->data + acm->buf_pos) << acm->bit_avail;
+		acm->buf_pos += (63 - acm->bit_avail) >> 3;
+		acm->bit_avail |= 56;
+	}
+	/* bit_avail < 64, so the shift is defined */
+	acm->bit_data >>= nbits;
+	acm->bit_avail -= nbits;
+	return 0;
+}
+
 /*************************************************
  * Table filling
  *************************************************/
@@ -170,181 +313,239 @@ static const int map_1bit[] = { -1, +1 };
 static const int map_2bit_near[] = { -2, -1, +1, +2 };
 static const int map_2bit_far[] = { -3, -2, +2, +3 };
 static const int map_3bit[] = { -4, -3, -2, -1, +1, +2, +3, +4 };
-static int mul_3x3[3*3*3];
-static int mul_3x5[5*5*5]; 
-static int mul_2x11[11*11];
-static int tables_generated;
 
-static void generate_tables(void)
-{
-	int x1, x2, x3;
-	if (tables_generated)
-		return;
-	for (x3 = 0; x3 < 3; x3++)
-		for (x2 = 0; x2 < 3; x2++)
-			for (x1 = 0; x1 < 3; x1++)
-				mul_3x3[x1 + x2*3 + x3*3*3] = 
-					x1 + (x2 << 4) + (x3 << 8);
-	for (x3 = 0; x3 < 5; x3++)
-		for (x2 = 0; x2 < 5; x2++)
-			for (x1 = 0; x1 < 5; x1++)
-				mul_3x5[x1 + x2*5 + x3*5*5] = 
-					x1 + (x2 << 4) + (x3 << 8);
-	for (x2 = 0; x2 < 11; x2++)
-		for (x1 = 0; x1 < 11; x1++)
-			mul_2x11[x1 + x2*11] = x1 + (x2 << 4);
-
-	tables_generated = 1;
-}
-
-/* IOW: (r * acm->subblock_len) + c */
-#define set_pos(acm, r, c, idx) do { \
-		unsigned _pos = ((r) << acm->info.acm_level) + (c); \
-		acm->block[_pos] = acm->midbuf[idx]; \
+/*
+ * Unpacked triples/pairs for f_t15, f_t27, f_t37.  Code is
+ * x1 + x2*N + x3*N*N, table gives values directly.
+ *
+ * Bit codes past the valid range can appear only in corrupt
+ * files, they decode as zeroes.
+ */
+#define T3_1(x2, x3) {-1, x2, x3}, {0, x2, x3}, {1, x2, x3}
+#define T3_2(x3) T3_1(-1, x3), T3_1(0, x3), T3_1(1, x3)
+
+#define T5_1(x2, x3) {-2, x2, x3}, {-1, x2, x3}, {0, x2, x3}, \
+		{1, x2, x3}, {2, x2, x3}
+#define T5_2(x3) T5_1(-2, x3), T5_1(-1, x3), T5_1(0, x3), \
+		T5_1(1, x3), T5_1(2, x3)
+
+#define T11_1(x2) {-5, x2}, {-4, x2}, {-3, x2}, {-2, x2}, {-1, x2}, \
+		{0, x2}, {1, x2}, {2, x2}, {3, x2}, {4, x2}, {5, x2}
+
+static const signed char map_3x3[1 << 5][3] = {
+	T3_2(-1), T3_2(0), T3_2(1)
+};
+
+static const signed char map_3x5[1 << 7][3] = {
+	T5_2(-2), T5_2(-1), T5_2(0), T5_2(1), T5_2(2)
+};
+
+static const signed char map_2x11[1 << 7][2] = {
+	T11_1(-5), T11_1(-4), T11_1(-3), T11_1(-2), T11_1(-1), T11_1(0),
+	T11_1(1), T11_1(2), T11_1(3), T11_1(4), T11_1(5)
+};
+
+/*
+ * Store row r of current column, see fill_block().
+ * Value is idx * amplitude step, unsigned multiply wraps
+ * the same way as the running sum it replaces.
+ */
+#define set_pos(acm, r, idx) do { \
+		acm->fill_col[(r) << acm->fill_shift] = \
+			(int)((unsigned)(idx) * acm->amp_step); \
 	} while (0)
 
+/* fill_fast() without stores, rows of entry are only counted */
+static unsigned skip_fast(ACMStream *acm, const uint32_t *tab)
+{
+	unsigned i = 0, rows = acm->info.acm_rows;
+	uint32_t e;
+
+	while (i + FILL_MAX_VALS <= rows) {
+		if (acm->bit_avail < FILL_PEEK_BITS) {
+			if (refill_bits(acm) < 0 || acm->bit_avail < FILL_PEEK_BITS)
+				break;
+		}
+		e = tab[acm->bit_data & ((1 << FILL_PEEK_BITS) - 1)];
+		acm->bit_data >>= (e >> 24) & 15;
+		acm->bit_avail -= (e >> 24) & 15;
+		i += e >> 28;
+	}
+	return i;
+}
+
+/*
+ * Decode several symbols at once, using table from filltab.h.
+ *
+ * Stops when less than FILL_MAX_VALS rows are left or near EOF,
+ * the filler itself continues from returned row bit-by-bit.
+ * Unused values in entry are written too, but those rows
+ * get overwritten later.
+ */
+static unsigned fill_fast(ACMStream *acm, const uint32_t *tab)
+{
+	unsigned i = 0, rows = acm->info.acm_rows;
+	uint32_t e;
+
+	if (acm->fill_skip)
+		return skip_fast(acm, tab);
+
+	while (i + FILL_MAX_VALS <= rows) {
+		if (acm->bit_avail < FILL_PEEK_BITS) {
+			if (refill_bits(acm) < 0 || acm->bit_avail < FILL_PEEK_BITS)
+				break;
+		}
+		e = tab[acm->bit_data & ((1 << FILL_PEEK_BITS) - 1)];
+		acm->bit_data >>= (e >> 24) & 15;
+		acm->bit_avail -= (e >> 24) & 15;
+
+		set_pos(acm, i + 0, (int)(e & 15) - 4);
+		set_pos(acm, i + 1, (int)((e >> 4) & 15) - 4);
+		set_pos(acm, i + 2, (int)((e >> 8) & 15) - 4);
+		set_pos(acm, i + 3, (int)((e >> 12) & 15) - 4);
+		set_pos(acm, i + 4, (int)((e >> 16) & 15) - 4);
+		set_pos(acm, i + 5, (int)((e >> 20) & 15) - 4);
+		i += e >> 28;
+	}
+	return i;
+}
+
 /************ Fillers **********/
 
-/*static int f_zero(ACMStream *acm, unsigned ind, unsigned col)*/
-static int32_t f_zero(ACMStream *acm, uint32_t col)
+static int f_zero(ACMStream *acm, unsigned ind)
 {
-	uint32_t i;
+	unsigned i;
 	for (i = 0; i < acm->info.acm_rows; i++)
-		set_pos(acm, i, col, 0);
+		set_pos(acm, i, 0);
 	
 	return 1;
 }
 
-char * goddamnfunctionstruct;
-
-static int f_bad(ACMStream *acm, unsigned col)
+static int f_bad(ACMStream *acm, unsigned ind)
 {
-	goddamnfunctionstruct = (char*)acm+col;
 	/* corrupt block? */
 	return ACM_ERR_CORRUPT;
 }
 
-uint32_t linear_index;
-
-static int f_linear(ACMStream *acm, unsigned col)
+static int f_linear(ACMStream *acm, unsigned ind)
 {
 	unsigned int i;
-	int b, middle = 1 << (linear_index - 1);
+	int b, middle = 1 << (ind - 1);
 
 	for (i = 0; i < acm->info.acm_rows; i++) {
-		GET_BITS(b, acm, linear_index);
-		set_pos(acm, i, col, b - middle);
+		GET_BITS(b, acm, ind);
+		set_pos(acm, i, b - middle);
 	}
 	return 1;
 }
 
-static int f_k13(ACMStream *acm, unsigned col)
+static int f_k13(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k13); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i++, col, 0);
+			set_pos(acm, i++, 0);
 			if (i >= acm->info.acm_rows)
 				break;
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 1, 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		/* 1, 1, ? */
 		GET_BITS(b, acm, 1);
-		set_pos(acm, i, col, map_1bit[b]);
+		set_pos(acm, i, map_1bit[b]);
 	}
 	return 1;
 }
 
-static int f_k12(ACMStream *acm, unsigned col)
+static int f_k12(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k12); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		/* 1, ? */
 		GET_BITS(b, acm, 1);
-		set_pos(acm, i, col, map_1bit[b]);
+		set_pos(acm, i, map_1bit[b]);
 	}
 	return 1;
 }
 
-static int f_k24(ACMStream *acm, unsigned col)
+static int f_k24(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k24); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i++, col, 0);
+			set_pos(acm, i++, 0);
 			if (i >= acm->info.acm_rows) break;
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 1, 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		/* 1, 1, ?, ? */
 		GET_BITS(b, acm, 2);
-		set_pos(acm, i, col, map_2bit_near[b]);
+		set_pos(acm, i, map_2bit_near[b]);
 	}
 	return 1;
 }
 
-static int f_k23(ACMStream *acm, unsigned col)
+static int f_k23(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k23); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 
 		/* 1, ?, ? */
 		GET_BITS(b, acm, 2);
-		set_pos(acm, i, col, map_2bit_near[b]);
+		set_pos(acm, i, map_2bit_near[b]);
 	}
 	return 1;
 }
 
-static int f_k35(ACMStream *acm, unsigned col)
+static int f_k35(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k35); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i++, col, 0);
+			set_pos(acm, i++, 0);
 			if (i >= acm->info.acm_rows)
 				break;
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 1, 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
@@ -352,25 +553,25 @@ static int f_k35(ACMStream *acm, unsigned col)
 		if (b == 0) {
 			/* 1, 1, 0, ? */
 			GET_BITS(b, acm, 1);
-			set_pos(acm, i, col, map_1bit[b]);
+			set_pos(acm, i, map_1bit[b]);
 			continue;
 		}
 		
 		/* 1, 1, 1, ?, ? */
 		GET_BITS(b, acm, 2);
-		set_pos(acm, i, col, map_2bit_far[b]);
+		set_pos(acm, i, map_2bit_far[b]);
 	}
 	return 1;
 }
 
-static int f_k34(ACMStream *acm, unsigned col)
+static int f_k34(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k34); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
@@ -378,128 +579,160 @@ static int f_k34(ACMStream *acm, unsigned col)
 		if (b == 0) {
 			/* 1, 0, ? */
 			GET_BITS(b, acm, 1);
-			set_pos(acm, i, col, map_1bit[b]);
+			set_pos(acm, i, map_1bit[b]);
 			continue;
 		}
 		
 		/* 1, 1, ?, ? */
 		GET_BITS(b, acm, 2);
-		set_pos(acm, i, col, map_2bit_far[b]);
+		set_pos(acm, i, map_2bit_far[b]);
 	}
 	return 1;
 }
 
-static int f_k45(ACMStream *acm, unsigned col)
+static int f_k45(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k45); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i, col, 0); i++;
+			set_pos(acm, i, 0); i++;
 			if (i >= acm->info.acm_rows)
 				break;
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		} 
 		
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 1, 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		/* 1, 1, ?, ?, ? */
 		GET_BITS(b, acm, 3);
-		set_pos(acm, i, col, map_3bit[b]);
+		set_pos(acm, i, map_3bit[b]);
 	}
 	return 1;
 }
 
-static int f_k44(ACMStream *acm, unsigned col)
+static int f_k44(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	for (i = 0; i < acm->info.acm_rows; i++) {
+	for (i = fill_fast(acm, tab_k44); i < acm->info.acm_rows; i++) {
 		GET_BITS(b, acm, 1);
 		if (b == 0) {
 			/* 0 */
-			set_pos(acm, i, col, 0);
+			set_pos(acm, i, 0);
 			continue;
 		}
 		
 		/* 1, ?, ?, ? */
 		GET_BITS(b, acm, 3);
-		set_pos(acm, i, col, map_3bit[b]);
+		set_pos(acm, i, map_3bit[b]);
 	}
 	return 1;
 }
 
-static int f_t15(ACMStream *acm, unsigned col)
+static int f_t15(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	int n1, n2, n3;
+	const signed char *n;
 	for (i = 0; i < acm->info.acm_rows; i++) {
 		/* b = (x1) + (x2 * 3) + (x3 * 9) */
 		GET_BITS(b, acm, 5);
+		n = map_3x3[b];
 		
-		n1 =  (mul_3x3[b] & 0x0F) - 1;
-		n2 = ((mul_3x3[b] >> 4) & 0x0F) - 1;
-		n3 = ((mul_3x3[b] >> 8) & 0x0F) - 1;
-		
-		set_pos(acm, i++, col, n1);
+		set_pos(acm, i++, n[0]);
 		if (i >= acm->info.acm_rows)
 			break;
-		set_pos(acm, i++, col, n2);
+		set_pos(acm, i++, n[1]);
 		if (i >= acm->info.acm_rows)
 			break;
-		set_pos(acm, i, col, n3);
+		set_pos(acm, i, n[2]);
 	}
 	return 1;
 }
 
-static int f_t27(ACMStream *acm, unsigned col)
+static int f_t27(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	int n1, n2, n3;
+	const signed char *n;
 	for (i = 0; i < acm->info.acm_rows; i++) {
 		/* b = (x1) + (x2 * 5) + (x3 * 25) */
 		GET_BITS(b, acm, 7);
-
-		n1 =  (mul_3x5[b] & 0x0F) - 2;
-		n2 = ((mul_3x5[b] >> 4) & 0x0F) - 2;
-		n3 = ((mul_3x5[b] >> 8) & 0x0F) - 2;
+		n = map_3x5[b];
 		
-		set_pos(acm, i++, col, n1);
+		set_pos(acm, i++, n[0]);
 		if (i >= acm->info.acm_rows)
 			break;
-		set_pos(acm, i++, col, n2);
+		set_pos(acm, i++, n[1]);
 		if (i >= acm->info.acm_rows)
 			break;
-		set_pos(acm, i, col, n3);
+		set_pos(acm, i, n[2]);
 	}
 	return 1;
 }
 
-static int f_t37(ACMStream *acm, unsigned col)
+static int f_t37(ACMStream *acm, unsigned ind)
 {
 	unsigned i, b;
-	int n1, n2;
+	const signed char *n;
 	for (i = 0; i < acm->info.acm_rows; i++) {
 		/* b = (x1) + (x2 * 11) */
 		GET_BITS(b, acm, 7);
+		n = map_2x11[b];
 		
-		n1 =  (mul_2x11[b] & 0x0F) - 5;
-		n2 = ((mul_2x11[b] >> 4) & 0x0F) - 5;
-		
-		set_pos(acm, i++, col, n1);
+		set_pos(acm, i++, n[0]);
 		if (i >= acm->info.acm_rows)
 			break;
-		set_pos(acm, i, col, n2);
+		set_pos(acm, i, n[1]);
 	}
 	return 1;
 }
 
+/*
+ * Fillers for acm_skip_block(), these only move in bit stream.
+ * Prefix codes still need parsing, for those normal filler
+ * runs into single column.
+ */
+
+static int s_zero(ACMStream *acm, unsigned ind)
+{
+	return 1;
+}
+
+static int s_linear(ACMStream *acm, unsigned ind)
+{
+	int err = acm_skip_bits(acm, ind * acm->info.acm_rows);
+	return err < 0 ? err : 1;
+}
+
+/* fixed size code for per_code rows */
+static int skip_codes(ACMStream *acm, unsigned bits, unsigned per_code)
+{
+	unsigned codes = (acm->info.acm_rows + per_code - 1) / per_code;
+	int err = acm_skip_bits(acm, codes * bits);
+	return err < 0 ? err : 1;
+}
+
+static int s_t15(ACMStream *acm, unsigned ind)
+{
+	return skip_codes(acm, 5, 3);
+}
+
+static int s_t27(ACMStream *acm, unsigned ind)
+{
+	return skip_codes(acm, 7, 3);
+}
+
+static int s_t37(ACMStream *acm, unsigned ind)
+{
+	return skip_codes(acm, 7, 2);
+}
+
 /****************/
 
 static const filler_t filler_list[] = {
@@ -513,16 +746,86 @@ static const filler_t filler_list[] = {
 	f_bad, f_t37, f_bad, f_bad		/* 28..31 */
 };
 
-static int fill_block(ACMStream *acm)
+static const filler_t skip_list[] = {
+	s_zero, f_bad, f_bad, s_linear, 	/* 0..3 */
+	s_linear, s_linear, s_linear, s_linear,	/* 4..7 */
+	s_linear, s_linear, s_linear, s_linear,	/* 8..11 */
+	s_linear, s_linear, s_linear, s_linear,	/* 12..15 */
+	s_linear, f_k13, f_k12, s_t15,		/* 16..19 */
+	f_k24, f_k23, s_t27, f_k35,		/* 20..23 */
+	f_k34, f_bad, f_k45, f_k44,		/* 24..27 */
+	f_bad, s_t37, f_bad, f_bad		/* 28..31 */
+};
+
+/*
+ * Copy filled tile to block, starting from column c0.  Tile is
+ * used only for more than FILL_TILE columns, always a multiple
+ * of it, so the width is constant.
+ */
+static void flush_tile(ACMStream *acm, unsigned c0)
+{
+	unsigned r, i, rows = acm->info.acm_rows;
+	const int *src;
+	int *dst = acm->block + c0;
+
+	for (r = 0; r < rows; r++) {
+		src = acm->tile + r;
+		for (i = 0; i < FILL_TILE; i++)
+			dst[i] = src[i * rows];
+		dst += acm->info.acm_cols;
+	}
+}
+
+/*
+ * Bit stream keeps columns together, but block is stored by rows.
+ * Big blocks are filled through a tile of FILL_TILE columns, so
+ * that writes to block go to whole cache lines.
+ *
+ * With skip, block is only parsed.  Prefix coded columns are
+ * all written over first rows words of block.
+ */
+static int fill_block(ACMStream *acm, int skip)
 {
-	unsigned i, ind;
+	unsigned i, c0, ind, rows = acm->info.acm_rows;
 	int err;
-	for (i = 0; i < acm->info.acm_cols; i++) {
-		GET_BITS_EXPECT_EOF(ind, acm, 5);
-		linear_index = ind;
-		err = filler_list[ind](acm, i);
-		if (err < 0)
-			return err;
+
+	acm->fill_skip = skip;
+	if (skip) {
+		acm->fill_shift = 0;
+		acm->fill_col = acm->block;
+		for (i = 0; i < acm->info.acm_cols; i++) {
+			GET_BITS_EXPECT_EOF(ind, acm, 5);
+			err = skip_list[ind](acm, ind);
+			if (err < 0)
+				return err;
+		}
+		return 1;
+	}
+
+	if (acm->tile == NULL) {
+		acm->fill_shift = acm->info.acm_level;
+		for (i = 0; i < acm->info.acm_cols; i++) {
+			acm->fill_col = acm->block + i;
+			GET_BITS_EXPECT_EOF(ind, acm, 5);
+			ACM_STAT(acm, fillers[ind]++);
+			err = filler_list[ind](acm, ind);
+			if (err < 0)
+				return err;
+		}
+		return 1;
+	}
+
+	acm->fill_shift = 0;
+	for (c0 = 0; c0 < acm->info.acm_cols; c0 += FILL_TILE) {
+		for (i = 0; i < FILL_TILE; i++) {
+			acm->fill_col = acm->tile + i * rows;
+			GET_BITS_EXPECT_EOF(ind, acm, 5);
+			ACM_STAT(acm, fillers[ind]++);
+			err = filler_list[ind](acm, ind);
+			if (err < 0)
+				return err;
+		}
+		flush_tile(acm, c0);
 	}
 	return 1;
 }
@@ -550,155 +853,511 @@ static void juggle(int *wrap_p, int *block_p, unsigned sub_len, unsigned sub_cou
 	}
 }
 
-static void juggle_block(ACMStream *acm)
+/*
+ * juggle() for narrow passes, width fixed at compile time.  Rows
+ * are walked once with all columns in registers, so chains of
+ * separate columns overlap instead of running one after another.
+ */
+#define JUGGLE_FIXED(w) \
+static void juggle_##w(int *wrap_p, int *block_p, unsigned sub_count) \
+{ \
+	int r0[w], r1[w], r2, r3, *p = block_p; \
+	unsigned i, j; \
+	for (i = 0; i < w; i++) { \
+		r0[i] = wrap_p[2*i]; \
+		r1[i] = wrap_p[2*i + 1]; \
+	} \
+	for (j = 0; j < sub_count/2; j++, p += 2*w) { \
+		for (i = 0; i < w; i++) { \
+			r2 = p[i];      p[i] = r1[i]*2 + (r0[i] + r2); \
+			r3 = p[w + i];  p[w + i] = r2*2 - (r1[i] + r3); \
+			r0[i] = r2;  r1[i] = r3; \
+		} \
+	} \
+	for (i = 0; i < w; i++) { \
+		wrap_p[2*i] = r0[i]; \
+		wrap_p[2*i + 1] = r1[i]; \
+	} \
+}
+
+JUGGLE_FIXED(1)
+JUGGLE_FIXED(2)
+JUGGLE_FIXED(4)
+
+/* one pass of sub_len w, w is constant */
+#define JUGGLE_PASS(acm, wrap_p, block_p, w, n) do { \
+		if ((w) == 1) \
+			juggle_1(wrap_p, block_p, n); \
+		else if ((w) == 2) \
+			juggle_2(wrap_p, block_p, n); \
+		else if ((w) == 4) \
+			juggle_4(wrap_p, block_p, n); \
+		else \
+			(acm)->juggle(wrap_p, block_p, w, n); \
+		wrap_p += 2 * (w); \
+	} while (0)
+
+/* rows juggled together, 2048 / subblock_len */
+#define JUGGLE_STEP(lev)	((lev) > 9 ? 1 : (2048 >> (lev)) - 2)
+
+/*
+ * Apply juggle()  (rows)x(cols)
+ * from (step_subcount * 2)            x (subblock_len/2)
+ * to   (step_subcount * subblock_len) x (1)
+ *
+ * One function per level, so column counts, strides and pass
+ * count are constants.  Passes wider than 4 columns go through
+ * acm->juggle, that may be SIMD.
+ *
+ * Bands of step_subcount rows depend on earlier ones only through
+ * wrapbuf, so rows row0..row1 can be done later than rows before
+ * them.  row0 is a multiple of JUGGLE_STEP().
+ */
+#define JUGGLE_BLOCK(lev) \
+static void juggle_block_##lev(ACMStream *acm, unsigned row0, unsigned row1) \
+{ \
+	const unsigned step_subcount = JUGGLE_STEP(lev); \
+	const unsigned sub_len0 = 1u << ((lev) - 1); \
+	unsigned todo_count = row1 - row0, sub_count, sub_len, i; \
+	int *wrap_p, *block_p = acm->block + (row0 << (lev)), *p; \
+\
+	while (1) { \
+		wrap_p = acm->wrapbuf; \
+		sub_count = step_subcount; \
+		if (sub_count > todo_count) \
+			sub_count = todo_count; \
+		sub_count *= 2; \
+\
+		JUGGLE_PASS(acm, wrap_p, block_p, sub_len0, sub_count); \
+		for (i = 0, p = block_p; i < sub_count; i++) { \
+			p[0]++; \
+			p += sub_len0; \
+		} \
+\
+		for (sub_len = sub_len0 / 2; sub_len > 4; sub_len /= 2) { \
+			sub_count *= 2; \
+			acm->juggle(wrap_p, block_p, sub_len, sub_count); \
+			wrap_p += sub_len*2; \
+		} \
+		if (sub_len0 > 4) { \
+			sub_count *= 2; \
+			JUGGLE_PASS(acm, wrap_p, block_p, 4, sub_count); \
+		} \
+		if (sub_len0 > 2) { \
+			sub_count *= 2; \
+			JUGGLE_PASS(acm, wrap_p, block_p, 2, sub_count); \
+		} \
+		if (sub_len0 > 1) { \
+			sub_count *= 2; \
+			JUGGLE_PASS(acm, wrap_p, block_p, 1, sub_count); \
+		} \
+		if (todo_count <= step_subcount) \
+			break; \
+		todo_count -= step_subcount; \
+		block_p += step_subcount << (lev); \
+	} \
+}
+
+/* juggle only if subblock_len > 1 */
+static void juggle_block_0(ACMStream *acm, unsigned row0, unsigned row1)
 {
-	unsigned sub_count, sub_len, todo_count, step_subcount, i;
-	int *wrap_p, *block_p, *p;
-	
-	/* juggle only if subblock_len > 1 */
-	if (acm->info.acm_level == 0)
-		return;
+}
 
-	/* 2048 / subblock_len */
-	if (acm->info.acm_level > 9)
-		step_subcount = 1;
-	else
-		step_subcount = (2048 >> acm->info.acm_level) - 2;
+JUGGLE_BLOCK(1)
+JUGGLE_BLOCK(2)
+JUGGLE_BLOCK(3)
+JUGGLE_BLOCK(4)
+JUGGLE_BLOCK(5)
+JUGGLE_BLOCK(6)
+JUGGLE_BLOCK(7)
+JUGGLE_BLOCK(8)
+JUGGLE_BLOCK(9)
+JUGGLE_BLOCK(10)
+JUGGLE_BLOCK(11)
+JUGGLE_BLOCK(12)
+JUGGLE_BLOCK(13)
+JUGGLE_BLOCK(14)
+JUGGLE_BLOCK(15)
+
+/* by acm_level, 4 bits in header */
+static const acm_block_func juggle_block_list[16] = {
+	juggle_block_0, juggle_block_1, juggle_block_2, juggle_block_3,
+	juggle_block_4, juggle_block_5, juggle_block_6, juggle_block_7,
+	juggle_block_8, juggle_block_9, juggle_block_10, juggle_block_11,
+	juggle_block_12, juggle_block_13, juggle_block_14, juggle_block_15
+};
 
-	/* Apply juggle()  (rows)x(cols)
-	 * from (step_subcount * 2)            x (subblock_len/2)
-	 * to   (step_subcount * subblock_len) x (1)
+/***************************************************************/
+/* read block header and fill it, without juggle */
+static int read_block(ACMStream *acm, int skip)
+{
+	unsigned max = acm->opts.max_values_per_byte, end;
+	int pwr, val, err;
+
+	/*
+	 * Read header.  pwr gave size of amplitude table, 1 << pwr
+	 * entries each way.  Indexes past it read stale or never set
+	 * table entries before, now every index gives idx * val, so
+	 * valid streams decode as before and pwr is not needed.
 	 */
-	todo_count = acm->info.acm_rows;
-	block_p = acm->block;
-	while (1) {
-		wrap_p = acm->wrapbuf;
-		sub_count = step_subcount;
-		if (sub_count > todo_count)
-			sub_count = todo_count;
-
-		sub_len = acm->info.acm_cols / 2;
-		sub_count *= 2;
-		
-		juggle(wrap_p, block_p, sub_len, sub_count);
-		wrap_p += sub_len*2;
-		
-		for (i = 0, p = block_p; i < sub_count; i++) {
-			p[0]++;
-			p += sub_len;
-		}
-		
-		while (sub_len > 1) {
-			sub_len /= 2;
-			sub_count *= 2;
-			juggle(wrap_p, block_p, sub_len, sub_count);
-			wrap_p += sub_len*2;
-		}
-		if (todo_count <= step_subcount)
-			break;
-		todo_count -= step_subcount;
-		block_p += step_subcount << acm->info.acm_level;
-	}
+	GET_BITS_EXPECT_EOF(pwr, acm, 4);
+	GET_BITS_EXPECT_EOF(val, acm, 16);
+	(void)pwr;
+	acm->amp_step = val;
+
+	if ((err = fill_block(acm, skip)) <= 0 || max == 0)
+		return err;
+
+	/* bits that expand too much are rejected, see ACMOptions */
+	end = acm->stream_pos + acm->block_len;
+	if (end > acm->total_values || end < acm->stream_pos)
+		end = acm->total_values;
+	if (end > (uint64_t)max * (acm->buf_start_ofs + acm->buf_pos))
+		return ACM_ERR_CORRUPT;
+	return err;
 }
 
-/***************************************************************/
-static int decode_block(ACMStream *acm)
+/* juggle block up to row1, bands before it must be done */
+static void juggle_rows(ACMStream *acm, unsigned row1)
+{
+	acm->juggle_block(acm, acm->juggle_row, row1);
+	acm->juggle_row = row1;
+	ACM_STAT_TIME(acm, juggle_ns);
+}
+
+/* fill block and juggle its first rows, rest is done on read */
+static int decode_block(ACMStream *acm, unsigned rows)
 {
-	int pwr, count, val, i, x, err;
+	int err;
 
 	acm->block_ready = 0;
 	acm->block_pos = 0;
 
-	/* read header */
-	GET_BITS_EXPECT_EOF(pwr, acm, 4);
-	GET_BITS_EXPECT_EOF(val, acm, 16);
-
-	/* generate tables */
-	count = 1 << pwr;
-	for (i = 0, x = 0; i < count; i++) {
-		acm->midbuf[i] = x;
-		x += val;
-	}
-	for (i = 1, x = -val; i <= count; i++) {
-		acm->midbuf[-i] = x;
-		x -= val;
-	}
+	if (acm->seek_idx != NULL)
+		acm_seek_index_add(acm);
 
-	/* to_check? */
-	if ((err = fill_block(acm)) <= 0)
+	ACM_STAT_START(acm);
+	if ((err = read_block(acm, 0)) <= 0)
 		return err;
+	ACM_STAT_TIME(acm, fill_ns);
 
-	juggle_block(acm);
+	acm->juggle_row = 0;
+	juggle_rows(acm, rows);
 
 	acm->block_ready = 1;
+	ACM_STAT(acm, blocks++);
 
 	return 1;
 }
 
-/******************************
- * Output formats
- ******************************/
+/* fed bytes not yet used, including whole bytes in accumulator */
+static unsigned push_avail(ACMStream *acm)
+{
+	return acm->buf_size - acm->buf_pos + acm->bit_avail / 8;
+}
 
-static unsigned char *out_s16le(int *src, unsigned char *dst, unsigned n, unsigned shift)
+/*
+ * Decode block only if all of it is fed, otherwise go back to
+ * block start and ask for more.  As the block is parsed again
+ * on next try, that waits for more data than last time and
+ * at least half of previous block size.
+ */
+static int push_decode_block(ACMStream *acm)
 {
-	while (n--) {
-		int val = *src++ >> shift;
-		*dst++ = val & 0xFF;
-		*dst++ = (val >> 8) & 0xFF;
+	uint64_t bit_data = acm->bit_data;
+	unsigned bit_avail = acm->bit_avail, buf_pos = acm->buf_pos;
+	unsigned avail = push_avail(acm);
+	int err;
+
+	if (!acm->push_eof && (avail <= acm->push_fail || avail < acm->push_hint))
+		return ACM_NEED_MORE_DATA;
+
+	err = decode_block(acm, acm->info.acm_rows);
+	if (!acm->push_eof && (err == ACM_EXPECTED_EOF
+			       || err == ACM_ERR_UNEXPECTED_EOF)) {
+		acm->bit_data = bit_data;
+		acm->bit_avail = bit_avail;
+		acm->buf_pos = buf_pos;
+		acm->push_fail = avail;
+		return ACM_NEED_MORE_DATA;
 	}
-	return dst;
+
+	acm->push_fail = 0;
+	if (err > 0)
+		acm->push_hint = (avail - push_avail(acm)) / 2;
+	return err;
 }
 
-static unsigned char *out_s16be(int *src, unsigned char *dst, unsigned n, unsigned shift)
+static int skip_block(ACMStream *acm, int skip)
 {
-	while (n--) {
-		int val = *src++ >> shift;
-		*dst++ = (val >> 8) & 0xFF;
-		*dst++ = val & 0xFF;
-	}
-	return dst;
+	int err;
+
+	if (acm->pcm_data != NULL)
+		return ACM_ERR_OTHER;
+
+	acm->block_ready = 0;
+	acm->block_pos = 0;
+	acm->split_len = 0;
+
+	if ((err = read_block(acm, skip)) <= 0)
+		return err;
+
+	acm->stream_pos += acm->block_len;
+	if (acm->stream_pos > acm->total_values)
+		acm->stream_pos = acm->total_values;
+	return 1;
 }
 
-static unsigned char *out_u16le(int *src, unsigned char *dst, unsigned n, unsigned shift)
+/*
+ * Parse next block only to find where it ends.  wrapbuf is
+ * not updated, so decoding cannot continue from here without
+ * restoring state.
+ */
+int acm_skip_block(ACMStream *acm)
 {
-	while (n--) {
-		int val = (*src++ >> shift) + 0x8000;
-		*dst++ = val & 0xFF;
-		*dst++ = (val >> 8) & 0xFF;
-	}
-	return dst;
+	return skip_block(acm, 1);
 }
 
-static unsigned char *out_u16be(int *src, unsigned char *dst, unsigned n, unsigned shift)
+/* Same as acm_skip_block(), but fills block like decoding does. */
+int acm_fill_block(ACMStream *acm)
 {
-	while (n--) {
-		int val = (*src++ >> shift) + 0x8000;
+	return skip_block(acm, 0);
+}
+
+/*
+ * Decode next block for a seek to word_pos inside it.  Block is
+ * juggled only up to the band of target, later bands are done by
+ * reads.  Returns 1 if stream is at word_pos, 0 on EOF or error code.
+ */
+int acm_seek_block(ACMStream *acm, unsigned word_pos)
+{
+	unsigned ofs = word_pos - acm->stream_pos, step, row1;
+	int err;
+
+	if (acm->block_ready || acm->push_mode || ofs >= acm->block_len
+	    || word_pos >= acm->total_values)
+		return ACM_ERR_OTHER;
+
+	step = JUGGLE_STEP(acm->info.acm_level);
+	row1 = ((ofs >> acm->info.acm_level) / step + 1) * step;
+	if (row1 > acm->info.acm_rows)
+		row1 = acm->info.acm_rows;
+
+	acm->split_len = 0;
+	err = decode_block(acm, row1);
+	if (err == ACM_EXPECTED_EOF)
+		return 0;
+	if (err < 0)
+		return err;
+	acm->stream_pos = word_pos;
+	acm->block_pos = ofs;
+	return 1;
+}
+
+/*
+ * Check whole stream by parsing it like seeks do: no filling,
+ * juggle or output.  Starts from beginning, rewinds at end if
+ * stream is seekable.  Returns 0 if all samples in header can be
+ * decoded, ACM_ERR_CORRUPT, ACM_ERR_UNEXPECTED_EOF or other error
+ * code.  rep is filled in all cases.
+ *
+ * Blocks have no sync marker, so after a bad block parsing goes on
+ * from where it stopped, as a reader that ignores errors would.
+ * Blocks after the first bad one show whether rest of the stream
+ * still makes sense, reads stop at the first one.
+ */
+int acm_verify(ACMStream *acm, ACMVerifyReport *rep)
+{
+	unsigned block = 0;
+	int err = 0;
+
+	memset(rep, 0, sizeof(*rep));
+	rep->pcm_header = acm->total_values / acm->info.channels;
+	if (acm->push_mode)
+		return ACM_ERR_NOT_SEEKABLE;
+	if (acm->pcm_data != NULL) {
+		rep->pcm_valid = rep->pcm_header;
+		return 0;
+	}
+	if (acm->stream_pos > 0 || acm->block_ready) {
+		if ((err = acm_rewind(acm)) < 0)
+			return err;
+	}
+
+	while (acm->stream_pos < acm->total_values) {
+		err = skip_block(acm, 1);
+		if (err == ACM_ERR_CORRUPT) {
+			if (rep->bad_blocks++ == 0) {
+				rep->first_bad = block;
+				rep->pcm_valid = acm->stream_pos / acm->info.channels;
+			}
+			rep->last_bad = block++;
+			acm->stream_pos += acm->block_len;
+			if (acm->stream_pos > acm->total_values)
+				acm->stream_pos = acm->total_values;
+			err = 0;
+			continue;
+		}
+		if (err <= 0)
+			break;
+		block++;
+		rep->blocks++;
+		err = 0;
+	}
+	if (err == ACM_EXPECTED_EOF || (err == 0 && acm->stream_pos < acm->total_values))
+		err = ACM_ERR_UNEXPECTED_EOF;
+	if (rep->bad_blocks > 0) {
+		if (err == 0 || err == ACM_ERR_UNEXPECTED_EOF)
+			err = ACM_ERR_CORRUPT;
+	} else {
+		rep->pcm_valid = acm->stream_pos / acm->info.channels;
+	}
+	rep->raw_end = acm->buf_start_ofs + acm->buf_pos;
+
+	if (acm->io.seek_func != NULL || acm->mem_data != NULL)
+		acm_rewind(acm);
+	return err;
+}
+
+/******************************
+ * Output formats
+ ******************************/
+
+static unsigned char *out_s16le(const int *src, unsigned char *dst, unsigned n, unsigned shift)
+{
+	while (n--) {
+		int val = *src++ >> shift;
+		*dst++ = val & 0xFF;
+		*dst++ = (val >> 8) & 0xFF;
+	}
+	return dst;
+}
+
+static unsigned char *out_s16be(const int *src, unsigned char *dst, unsigned n, unsigned shift)
+{
+	while (n--) {
+		int val = *src++ >> shift;
 		*dst++ = (val >> 8) & 0xFF;
 		*dst++ = val & 0xFF;
 	}
 	return dst;
 }
 
-static int output_values(int *src, unsigned char *dst, int n,
-		int acm_level, int bigendianp, int wordlen, int sgned)
+static unsigned char *out_u16le(const int *src, unsigned char *dst, unsigned n, unsigned shift)
 {
-	unsigned char *res = NULL;
-	if (wordlen == 2) {
-		if (bigendianp == 0) {
-			if (sgned)
-				res = out_s16le(src, dst, n, acm_level);
-			else
-				res = out_u16le(src, dst, n, acm_level);
-		} else {
-			if (sgned)
-				res = out_s16be(src, dst, n, acm_level);
-			else
-				res = out_u16be(src, dst, n, acm_level);
-		}
+	while (n--) {
+		int val = (*src++ >> shift) + 0x8000;
+		*dst++ = val & 0xFF;
+		*dst++ = (val >> 8) & 0xFF;
+	}
+	return dst;
+}
+
+static unsigned char *out_u16be(const int *src, unsigned char *dst, unsigned n, unsigned shift)
+{
+	while (n--) {
+		int val = (*src++ >> shift) + 0x8000;
+		*dst++ = (val >> 8) & 0xFF;
+		*dst++ = val & 0xFF;
 	}
-	if (res != NULL)
-		return res - dst;
-	return ACM_ERR_BADFMT;
+	return dst;
+}
+
+/*
+ * Native-order kernels for acm_read_frames(), one set per sample type.
+ * Planar ones take frames of step words; with step 1 (mono) the one
+ * channel goes to every plane.  The 2-plane version reads each frame
+ * once, the generic one makes a pass per plane.
+ */
+#define CONV_S16(v, shift)	((int16_t)((v) >> (shift)))
+#define CONV_U16(v, shift)	((uint16_t)(((v) >> (shift)) + 0x8000))
+#define CONV_S32(v, shift)	((int32_t)((uint32_t)(v) << (16 - (shift))))
+#define CONV_F32(v, shift)	((v) * (1.0f / (float)(32768u << (shift))))
+
+#define FRAMES_FUNCS(name, type, conv) \
+static void frames_##name(const int *src, void *dst, unsigned n, unsigned shift) \
+{ \
+	type *d = (type *)dst; \
+	unsigned i; \
+	for (i = 0; i < n; i++) \
+		d[i] = conv(src[i], shift); \
+} \
+static void planar_##name(const int *src, unsigned step, void **dst, \
+			  unsigned nplanes, unsigned pos, unsigned n, unsigned shift) \
+{ \
+	unsigned i, c; \
+	for (c = 0; c < nplanes; c++) { \
+		type *d = (type *)dst[c] + pos; \
+		const int *s = src + (step > 1 ? c : 0); \
+		for (i = 0; i < n; i++, s += step) \
+			d[i] = conv(*s, shift); \
+	} \
+} \
+static void planar2_##name(const int *src, unsigned step, void **dst, \
+			   unsigned nplanes, unsigned pos, unsigned n, unsigned shift) \
+{ \
+	type *l = (type *)dst[0] + pos, *r = (type *)dst[1] + pos; \
+	unsigned i; \
+	(void)nplanes; \
+	for (i = 0; i < n; i++, src += step) { \
+		l[i] = conv(src[0], shift); \
+		r[i] = conv(src[step - 1], shift); \
+	} \
+}
+
+FRAMES_FUNCS(s16, int16_t, CONV_S16)
+FRAMES_FUNCS(u16, uint16_t, CONV_U16)
+FRAMES_FUNCS(s32, int32_t, CONV_S32)
+FRAMES_FUNCS(f32, float, CONV_F32)
+
+/* in ACM_SAMPLE_* order */
+static const acm_frames_func frames_list[ACM_SAMPLE_COUNT] = {
+	frames_s16, frames_u16, frames_s32, frames_f32,
+};
+static const acm_planar_func planar_list[ACM_SAMPLE_COUNT] = {
+	planar_s16, planar_u16, planar_s32, planar_f32,
+};
+static const acm_planar_func planar2_list[ACM_SAMPLE_COUNT] = {
+	planar2_s16, planar2_u16, planar2_s32, planar2_f32,
+};
+
+static const unsigned char sample_size[ACM_SAMPLE_COUNT] = { 2, 2, 4, 4 };
+
+static int output_values(ACMStream *acm, const int *src, unsigned char *dst,
+		int n, int bigendianp, int wordlen, int sgned)
+{
+	unsigned char *res;
+	unsigned fmt;
+
+	if (wordlen != 2)
+		return ACM_ERR_BADFMT;
+
+	fmt = (bigendianp ? ACM_OUT_S16BE : ACM_OUT_S16LE)
+		+ (sgned ? 0 : ACM_OUT_U16LE);
+	ACM_STAT_START(acm);
+	res = acm->out_func[fmt](src, dst, n, acm->info.acm_level);
+	ACM_STAT_TIME(acm, output_ns);
+	return res - dst;
+}
+
+/* scalar kernels, reference for simd.c */
+void acm_scalar_kernels(ACMStream *acm)
+{
+	acm->out_func[ACM_OUT_S16LE] = out_s16le;
+	acm->out_func[ACM_OUT_U16LE] = out_u16le;
+	acm->out_func[ACM_OUT_S16BE] = out_s16be;
+	acm->out_func[ACM_OUT_U16BE] = out_u16be;
+	memcpy(acm->frames_func, frames_list, sizeof(frames_list));
+	memcpy(acm->planar_func, planar_list, sizeof(planar_list));
+	memcpy(acm->planar2_func, planar2_list, sizeof(planar2_list));
+	acm->juggle = juggle;
+	acm->juggle_block = juggle_block_list[acm->info.acm_level];
+}
+
+static void init_kernels(ACMStream *acm)
+{
+	acm_scalar_kernels(acm);
+	acm_simd_init(acm);
 }
 
 /*
@@ -709,6 +1368,10 @@ static int output_values(int *src, unsigned char *dst, int n,
 
 #define WAVC_ID 0x564157  /* 'WAV' */
 
+/* header sizes in bytes */
+#define ACM_HEADER_LEN	14
+#define WAVC_HEADER_LEN	28
+
 static int read_wavc_header(ACMStream *acm)
 {
 	static const unsigned short expect[12] = {
@@ -780,34 +1443,109 @@ static int read_header(ACMStream *acm)
  * Public functions
  ***********************************************/
 
-int acm_open_decoder(ACMStream **res, void *arg, acm_io_callbacks io_cb, int force_chans)
+/*
+ * Memory allocation, through ACMOptions callbacks if given.
+ */
+
+void *acm_mem_alloc(ACMStream *acm, size_t size)
 {
-	int err = ACM_ERR_OTHER;
-	ACMStream *acm;
-	
-	acm = (ACMStream*)malloc(sizeof(*acm));
+	if (acm->opts.alloc_func)
+		return acm->opts.alloc_func(size, acm->opts.alloc_arg);
+	return malloc(size);
+}
+
+void acm_mem_free(ACMStream *acm, void *ptr)
+{
+	if (ptr == NULL)
+		return;
+	if (acm->opts.free_func)
+		acm->opts.free_func(ptr, acm->opts.alloc_arg);
+	else if (!acm->opts.alloc_func)
+		free(ptr);
+}
+
+/* callbacks have no realloc, so copy */
+void *acm_mem_realloc(ACMStream *acm, void *ptr, size_t old_size, size_t size)
+{
+	void *res;
+
+	if (!acm->opts.alloc_func)
+		return realloc(ptr, size);
+	res = acm_mem_alloc(acm, size);
+	if (res == NULL)
+		return NULL;
+	if (ptr != NULL) {
+		memcpy(res, ptr, old_size < size ? old_size : size);
+		acm_mem_free(acm, ptr);
+	}
+	return res;
+}
+
+static ACMStream *new_stream(const ACMOptions *opts)
+{
+	ACMStream tmp, *acm;
+
+	/* allocator must be known before stream exists */
+	memset(&tmp, 0, sizeof(tmp));
+	if (opts != NULL)
+		tmp.opts = *opts;
+	acm = (ACMStream*)acm_mem_alloc(&tmp, sizeof(*acm));
 	if (!acm)
-		return err;
+		return NULL;
 	memset(acm, 0, sizeof(*acm));
+	acm->opts = tmp.opts;
+	return acm;
+}
 
-	acm->io_arg = arg;
-	acm->io = io_cb;
+/* get buffers for current level and rows, keeping big enough ones */
+static int alloc_buffers(ACMStream *acm)
+{
+	unsigned n;
 
-	if (acm->io.get_length_func) {
-		acm->data_len = acm->io.get_length_func(acm->io_arg);
-	} else {
-		acm->data_len = 0;
+	if (acm->block == NULL || acm->block_len > acm->block_max) {
+		acm_mem_free(acm, acm->block);
+		acm->block = (int*)acm_mem_alloc(acm, acm->block_len * sizeof(int));
+		acm->block_max = acm->block ? acm->block_len : 0;
 	}
-	
-	acm->buf_max = ACM_BUFLEN;
-	acm->buf = (unsigned char*)malloc(acm->buf_max);
-	if (!acm->buf) 
-		goto err_out;
 
+	/* level 0 has no wrapbuf, keep a minimal one */
+	n = acm->wrapbuf_len > 0 ? acm->wrapbuf_len : 1;
+	if (acm->wrapbuf == NULL || n > acm->wrapbuf_max) {
+		acm_mem_free(acm, acm->wrapbuf);
+		acm->wrapbuf = (int*)acm_mem_alloc(acm, n * sizeof(int));
+		acm->wrapbuf_max = acm->wrapbuf ? n : 0;
+	}
+
+	/* see fill_block() */
+	if (acm->block_len >= FILL_TILE_WORDS
+	    && acm->info.acm_cols > FILL_TILE) {
+		n = FILL_TILE * acm->info.acm_rows;
+		if (acm->tile == NULL || n > acm->tile_max) {
+			acm_mem_free(acm, acm->tile);
+			acm->tile = (int*)acm_mem_alloc(acm, n * sizeof(int));
+			acm->tile_max = acm->tile ? n : 0;
+			if (!acm->tile)
+				return ACM_ERR_OTHER;
+		}
+	} else if (acm->tile != NULL) {
+		acm_mem_free(acm, acm->tile);
+		acm->tile = NULL;
+		acm->tile_max = 0;
+	}
+
+	if (!acm->block || !acm->wrapbuf)
+		return ACM_ERR_OTHER;
+
+	memset(acm->wrapbuf, 0, acm->wrapbuf_len * sizeof(int));
+	return ACM_OK;
+}
+
+/* read header and fill stream info */
+static int parse_header(ACMStream *acm, int force_chans)
+{
 	/* read header data */
-	err = ACM_ERR_NOT_ACM;
 	if (read_header(acm) < 0)
-		goto err_out;
+		return ACM_ERR_NOT_ACM;
 
 	/*
 	 * Overwrite channel info if requested, otherwise
@@ -817,6 +1555,9 @@ int acm_open_decoder(ACMStream **res, void *arg, acm_io_callbacks io_cb, int for
 	 *
 	 * Trust WAVC files, as they seem to be correct?
 	 */
+	acm->force_chans = force_chans;
+	if (force_chans > 2)
+		return ACM_ERR_BADFMT;
 	if (force_chans > 0)
 		acm->info.channels = force_chans;
 	else if (!acm->wavc_file && acm->info.channels < 2)
@@ -826,16 +1567,83 @@ int acm_open_decoder(ACMStream **res, void *arg, acm_io_callbacks io_cb, int for
 	acm->info.acm_cols = 1 << acm->info.acm_level;
 	acm->wrapbuf_len = 2 * acm->info.acm_cols - 2;
 	acm->block_len = acm->info.acm_rows * acm->info.acm_cols;
+	return ACM_OK;
+}
+
+/* limits from ACMOptions, known from header */
+static int check_limits(ACMStream *acm)
+{
+	const ACMOptions *o = &acm->opts;
+	uint64_t words = (uint64_t)acm->block_len + acm->wrapbuf_len;
+
+	if (acm->block_len >= FILL_TILE_WORDS && acm->info.acm_cols > FILL_TILE)
+		words += FILL_TILE * acm->info.acm_rows;
+	if (o->max_block_mem > 0 && words * sizeof(int) > o->max_block_mem)
+		return ACM_ERR_BADFMT;
+	/* length is not known for push streams, read_block() checks */
+	if (o->max_values_per_byte > 0 && acm->data_len > 0
+	    && acm->total_values > (uint64_t)o->max_values_per_byte * acm->data_len)
+		return ACM_ERR_BADFMT;
+	return ACM_OK;
+}
+
+/* read header and allocate decoding buffers */
+static int init_stream(ACMStream *acm, int force_chans)
+{
+	int err;
+
+	if ((err = parse_header(acm, force_chans)) < 0)
+		return err;
+	if ((err = check_limits(acm)) < 0)
+		return err;
 
 	/* allocate */
-	acm->block = (int*)malloc(acm->block_len * sizeof(int));
-	acm->wrapbuf = (int*)malloc(acm->wrapbuf_len * sizeof(int));
-	acm->ampbuf = (int*)malloc(0x10000 * sizeof(int));
-	acm->midbuf = acm->ampbuf + 0x8000;
+	if ((err = alloc_buffers(acm)) < 0)
+		return err;
 
-	memset(acm->wrapbuf, 0, acm->wrapbuf_len * sizeof(int));
+	init_kernels(acm);
+	return ACM_OK;
+}
+
+/*
+ * Parse header from first bytes of file, without a stream.
+ * 14 bytes are needed, 42 for WAVC files.  Channel count is
+ * adjusted like acm_open_decoder() does.  Returns 0 or error code.
+ */
+int acm_probe(const void *hdr, size_t len, ACMInfo *out, unsigned *total_values)
+{
+	ACMStream tmp;
+	int err;
 
-	generate_tables();
+	if (hdr == NULL || (unsigned)len != len)
+		return ACM_ERR_OTHER;
+
+	/* memory backend reads without any buffer */
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.mem_data = (const unsigned char *)hdr;
+	tmp.mem_len = len;
+	tmp.data_len = len;
+
+	if ((err = parse_header(&tmp, 0)) < 0)
+		return err;
+	*out = tmp.info;
+	if (total_values)
+		*total_values = tmp.total_values;
+	return ACM_OK;
+}
+
+/* allocate read buffer and parse header, frees acm on error */
+static int open_io(ACMStream **res, ACMStream *acm, int force_chans)
+{
+	int err = ACM_ERR_OTHER;
+
+	acm->buf_max = ACM_BUFLEN;
+	acm->buf = (unsigned char*)acm_mem_alloc(acm, acm->buf_max + ACM_BUF_PAD);
+	if (!acm->buf) 
+		goto err_out;
+
+	if ((err = init_stream(acm, force_chans)) < 0)
+		goto err_out;
 
 	*res = acm;
 	return ACM_OK;
@@ -849,56 +1657,551 @@ err_out:
 	return err;
 }
 
-int acm_read(ACMStream *acm, void *dst, unsigned numbytes,
-		 int bigendianp, int wordlen, int sgned)
+int acm_open_decoder(ACMStream **res, void *arg, acm_io_callbacks io_cb, int force_chans)
+{
+	return acm_open_decoder_ex(res, arg, io_cb, force_chans, NULL);
+}
+
+/*
+ * Same as acm_open_decoder(), but with options.
+ * opts may be NULL, it is copied.
+ */
+int acm_open_decoder_ex(ACMStream **res, void *arg, acm_io_callbacks io_cb,
+			int force_chans, const ACMOptions *opts)
+{
+	ACMStream *acm;
+	
+	acm = new_stream(opts);
+	if (!acm)
+		return ACM_ERR_OTHER;
+
+	acm->io_arg = arg;
+	acm->io = io_cb;
+
+	if (acm->io.get_length_func) {
+		acm->data_len = acm->io.get_length_func(acm->io_arg);
+	} else {
+		acm->data_len = 0;
+	}
+	return open_io(res, acm, force_chans);
+}
+
+/*
+ * v1 callbacks over window of v2 source, arg is the stream.
+ * Offsets inside window fit into unsigned, see acm_open_decoder_v2().
+ */
+static int win_read(void *dst, int size, int n, void *arg)
 {
-	int avail, gotbytes = 0, err;
-	int *src, numwords;
+	ACMStream *acm = (ACMStream *)arg;
+	unsigned len = (unsigned)size * n, left = acm->win_len - acm->win_pos;
+	int res;
+
+	if (len > left)
+		len = left;
+	if (len == 0)
+		return 0;
+	res = acm->win_io.read_at(acm->win_arg, dst, len, acm->win_base + acm->win_pos);
+	if (res < 0)
+		return -1;
+	acm->win_pos += res;
+	return res;
+}
 
-	if (wordlen == 2)
-		numwords = numbytes / 2;
+static int win_seek(void *arg, int offset, int whence)
+{
+	ACMStream *acm = (ACMStream *)arg;
+	uint64_t pos;
+
+	/* decoder seeks only with SEEK_SET, up to 4G */
+	if (whence == SEEK_SET)
+		pos = (unsigned)offset;
+	else if (whence == SEEK_CUR)
+		pos = (uint64_t)acm->win_pos + offset;
 	else
-		return ACM_ERR_BADFMT;
+		pos = (uint64_t)acm->win_len + offset;
+	if (pos > acm->win_len)
+		return -1;
+	acm->win_pos = pos;
+	return 0;
+}
+
+static int win_close(void *arg)
+{
+	ACMStream *acm = (ACMStream *)arg;
+
+	if (acm->win_io.close_func)
+		return acm->win_io.close_func(acm->win_arg);
+	return 0;
+}
+
+/*
+ * Decode stream at base of v2 source.  base is 64-bit, but offsets
+ * inside window are not: only first 4G of window is used, more
+ * than any ACM stream needs.  len 0 means up to end of source.  Streams from this cannot be
+ * given to acm_reset().
+ */
+int acm_open_decoder_v2(ACMStream **res, void *arg, const acm_io_callbacks_v2 *io,
+			uint64_t base, uint64_t len, int force_chans,
+			const ACMOptions *opts)
+{
+	ACMStream *acm;
+	int64_t total;
+
+	if (io->read_at == NULL)
+		return ACM_ERR_OTHER;
+	if (len == 0 && io->get_length_func) {
+		total = io->get_length_func(arg);
+		if (total < 0 || (uint64_t)total <= base)
+			return ACM_ERR_NOT_ACM;
+		len = total - base;
+	}
+
+	acm = new_stream(opts);
+	if (!acm)
+		return ACM_ERR_OTHER;
+
+	acm->win_arg = arg;
+	acm->win_io = *io;
+	acm->win_base = base;
+	/* unknown length still reads until source ends */
+	acm->win_len = len > 0 && len < UINT32_MAX ? len : UINT32_MAX;
+	acm->data_len = len < UINT32_MAX ? len : UINT32_MAX;
+
+	acm->io_arg = acm;
+	acm->io.read_func = win_read;
+	acm->io.seek_func = win_seek;
+	acm->io.close_func = win_close;
+	return open_io(res, acm, force_chans);
+}
+
+/*
+ * Decode from memory.  No copy is made, data must stay valid
+ * until acm_close().  Seeking is always possible.
+ */
+int acm_open_memory(ACMStream **res, const void *data, size_t len, int force_chans)
+{
+	return acm_open_memory_ex(res, data, len, force_chans, NULL);
+}
+
+/*
+ * Same as acm_open_memory(), but with options.
+ * opts may be NULL, it is copied.
+ */
+int acm_open_memory_ex(ACMStream **res, const void *data, size_t len,
+		       int force_chans, const ACMOptions *opts)
+{
+	int err;
+	ACMStream *acm;
+
+	if (data == NULL || (unsigned)len != len)
+		return ACM_ERR_OTHER;
+
+	acm = new_stream(opts);
+	if (!acm)
+		return ACM_ERR_OTHER;
+
+	acm->mem_data = (const unsigned char *)data;
+	acm->mem_len = len;
+	acm->data_len = len;
+
+	if ((err = init_stream(acm, force_chans)) < 0) {
+		acm_close(acm);
+		return err;
+	}
+
+	*res = acm;
+	return ACM_OK;
+}
+
+/*
+ * Stream over values decoded earlier, as acm_read_block_ptr()
+ * gives them.  Nothing is copied, values must stay valid until
+ * acm_close(), which calls release(arg).  Reads and seeks work
+ * like on a decoder stream, raw_len is used for bitrate.
+ */
+int acm_open_pcm(ACMStream **res, const int *values, unsigned total_values,
+		 const ACMInfo *info, unsigned raw_len,
+		 int (*release)(void *arg), void *arg)
+{
+	ACMStream *acm;
+
+	if (values == NULL || info->channels == 0 || info->acm_rows == 0)
+		return ACM_ERR_OTHER;
+
+	acm = new_stream(NULL);
+	if (!acm)
+		return ACM_ERR_OTHER;
+
+	acm->info = *info;
+	acm->total_values = total_values;
+	acm->data_len = raw_len;
+	acm->pcm_data = values;
+	acm->block_len = info->acm_rows * info->acm_cols;
+	acm->io.close_func = release;
+	acm->io_arg = arg;
+	init_kernels(acm);
+
+	*res = acm;
+	return ACM_OK;
+}
+
+/*
+ * Decode data given with acm_feed(), without blocking on input.
+ * Header is parsed by first read that has enough data, stream
+ * info is valid after that.  Reads return ACM_NEED_MORE_DATA
+ * until whole next block is fed, last block may need end of
+ * input.  Stream is not seekable.  opts may be NULL.
+ */
+int acm_open_push(ACMStream **res, int force_chans, const ACMOptions *opts)
+{
+	ACMStream *acm;
+
+	acm = new_stream(opts);
+	if (!acm)
+		return ACM_ERR_OTHER;
+
+	acm->push_mode = 1;
+	acm->force_chans = force_chans;
+	acm->buf_max = ACM_BUFLEN;
+	acm->buf = (unsigned char*)acm_mem_alloc(acm, acm->buf_max + ACM_BUF_PAD);
+	if (!acm->buf) {
+		acm_close(acm);
+		return ACM_ERR_OTHER;
+	}
+	memset(acm->buf, 0, ACM_BUF_PAD);
+	acm->data = acm->buf;
+
+	*res = acm;
+	return ACM_OK;
+}
+
+/*
+ * Append input for push stream, data is copied.  NULL or
+ * zero len marks end of input.
+ */
+int acm_feed(ACMStream *acm, const void *data, unsigned len)
+{
+	unsigned left, max;
+	unsigned char *tmp;
+
+	if (!acm->push_mode || acm->push_eof)
+		return ACM_ERR_OTHER;
+	if (data == NULL || len == 0) {
+		acm->push_eof = 1;
+		return ACM_OK;
+	}
+
+	if (len > acm->buf_max - acm->buf_size) {
+		/* drop used bytes */
+		left = acm->buf_size - acm->buf_pos;
+		memmove(acm->buf, acm->buf + acm->buf_pos, left);
+		acm->buf_start_ofs += acm->buf_pos;
+		acm->buf_pos = 0;
+		acm->buf_size = left;
+
+		for (max = acm->buf_max; len > max - left; max *= 2) {
+			if (max > (~0u - ACM_BUF_PAD) / 2)
+				return ACM_ERR_OTHER;
+		}
+		if (max > acm->buf_max) {
+			tmp = (unsigned char*)acm_mem_realloc(acm, acm->buf,
+					acm->buf_max + ACM_BUF_PAD, max + ACM_BUF_PAD);
+			if (!tmp)
+				return ACM_ERR_OTHER;
+			acm->buf = tmp;
+			acm->buf_max = max;
+		}
+		acm->data = acm->buf;
+	}
+
+	memcpy(acm->buf + acm->buf_size, data, len);
+	acm->buf_size += len;
+	memset(acm->buf + acm->buf_size, 0, ACM_BUF_PAD);
+	return ACM_OK;
+}
+
+/* parse header once all of it is fed */
+static int push_header(ACMStream *acm)
+{
+	unsigned need = ACM_HEADER_LEN;
+
+	if (acm->buf_size >= 3 && memcmp(acm->buf, "WAV", 3) == 0)
+		need += WAVC_HEADER_LEN;
+	if (acm->buf_size < need && !acm->push_eof)
+		return ACM_NEED_MORE_DATA;
+	return init_stream(acm, acm->force_chans);
+}
+
+/*
+ * Start decoding new file with same callbacks, old io_arg is
+ * closed.  Buffers are reused if new file fits into them.
+ * For streams from acm_open_file() io_arg is FILE *.
+ * On error the stream can only be closed.
+ */
+int acm_reset(ACMStream *acm, void *io_arg)
+{
+	/* memory, push and window streams have no callbacks to reuse */
+	if (acm->mem_data != NULL || acm->pcm_data != NULL || acm->push_mode
+	    || acm->win_io.read_at != NULL)
+		return ACM_ERR_OTHER;
+
+	if (acm->io.close_func)
+		acm->io.close_func(acm->io_arg);
+	acm->io_arg = io_arg;
+
+	acm_free_seek_index(acm);
+	memset(&acm->info, 0, sizeof(acm->info));
+	acm->total_values = 0;
+
+	if (acm->io.get_length_func)
+		acm->data_len = acm->io.get_length_func(acm->io_arg);
+	else
+		acm->data_len = 0;
+
+	acm->buf_size = acm->buf_pos = 0;
+	acm->buf_start_ofs = 0;
+	acm->bit_data = 0;
+	acm->bit_avail = 0;
+	acm->block_ready = 0;
+	acm->file_eof = 0;
+	acm->wavc_file = 0;
+	acm->stream_pos = 0;
+	acm->block_pos = 0;
+	acm->split_len = 0;
+
+	return init_stream(acm, acm->force_chans);
+}
+
+/* pcm view has no decoding, block is a window into values */
+static int view_block(ACMStream *acm)
+{
+	unsigned start = acm->stream_pos - acm->stream_pos % acm->block_len;
+
+	acm->block = (int *)acm->pcm_data + start;
+	acm->block_pos = acm->stream_pos - start;
+	acm->juggle_row = acm->info.acm_rows;
+	acm->block_ready = 1;
+	return 1;
+}
+
+/* decode next block, 1 if ready, 0 on EOF or error code */
+static int next_block(ACMStream *acm)
+{
+	int err;
+
+	if (acm->pcm_data != NULL)
+		err = view_block(acm);
+	else if (acm->push_mode)
+		err = push_decode_block(acm);
+	else
+		err = decode_block(acm, acm->info.acm_rows);
+	return err == ACM_EXPECTED_EOF ? 0 : err;
+}
+
+/* words taken from block, they stay valid until next read */
+static void consume_words(ACMStream *acm, unsigned numwords)
+{
+	acm->stream_pos += numwords;
+	acm->block_pos += numwords;
+	if (acm->block_pos == acm->block_len)
+		acm->block_ready = 0;
+}
+
+/*
+ * Frame that spans two blocks, when block_len is not a multiple of
+ * channels: level 0 with odd acm_rows on 2 channels.  Words from
+ * block end are already in split and counted in stream_pos, rest
+ * come from start of next block.  Returns words of whole frame,
+ * 0 on EOF or error code, split is kept for next try.
+ */
+static int split_frame(ACMStream *acm, const int **src)
+{
+	unsigned need = acm->info.channels - acm->split_len;
+	int err;
+
+	if (!acm->block_ready) {
+		if ((err = next_block(acm)) <= 0)
+			return err;
+	}
+	memcpy(acm->split + acm->split_len, acm->block + acm->block_pos,
+	       need * sizeof(int));
+	consume_words(acm, need);
+	acm->split_len = 0;
+	*src = acm->split;
+	return acm->info.channels;
+}
+
+/*
+ * Decode block as needed and take up to numwords from it.  With
+ * frames, count is rounded to whole frames and a frame split by
+ * block end is put together in split.  Returns words taken,
+ * 0 on EOF or error code.
+ */
+static int take_words(ACMStream *acm, unsigned numwords, int frames,
+		      const int **src)
+{
+	unsigned chans, want = numwords, avail;
+	int err;
+
+	if (acm->push_mode && acm->total_values == 0) {
+		if ((err = push_header(acm)) < 0)
+			return err;
+	}
+	/* known only after header */
+	chans = frames ? acm->info.channels : 1;
+
+	if (acm->split_len > 0)
+		return split_frame(acm, src);
 
 	if (acm->stream_pos >= acm->total_values)
 		return 0;
 
 	if (!acm->block_ready) {
-		err = decode_block(acm);
-		if (err == ACM_EXPECTED_EOF)
-			return 0;
-		if (err < 0)
+		if ((err = next_block(acm)) <= 0)
 			return err;
 	}
 
 	/* check how many words can be read */
-	avail = acm->block_len - acm->block_pos;
+	avail = (acm->juggle_row << acm->info.acm_level) - acm->block_pos;
+	if (avail < chans && acm->juggle_row < acm->info.acm_rows) {
+		/* rest of block after acm_seek_block() */
+		ACM_STAT_START(acm);
+		juggle_rows(acm, acm->info.acm_rows);
+		avail = acm->block_len - acm->block_pos;
+	}
 	if (avail < numwords)
 		numwords = avail;
 
 	if (acm->stream_pos + numwords > acm->total_values)
 		numwords = acm->total_values - acm->stream_pos;
 
-	if (acm->info.channels > 1)
-		numwords -= numwords % acm->info.channels;
+	/* end on frame boundary */
+	numwords -= (acm->stream_pos + numwords) % chans;
+
+	if (numwords == 0 && want >= chans && avail < chans
+	    && acm->stream_pos % chans == 0
+	    && acm->stream_pos + chans <= acm->total_values) {
+		memcpy(acm->split, acm->block + acm->block_pos, avail * sizeof(int));
+		acm->split_len = avail;
+		consume_words(acm, avail);
+		return split_frame(acm, src);
+	}
+
+	*src = acm->block + acm->block_pos;
+	consume_words(acm, numwords);
+	return numwords;
+}
+
+int acm_read(ACMStream *acm, void *dst, unsigned numbytes,
+		 int bigendianp, int wordlen, int sgned)
+{
+	const int *src;
+	int numwords;
+
+	if (wordlen != 2)
+		return ACM_ERR_BADFMT;
+
+	numwords = take_words(acm, numbytes / 2, 1, &src);
+	if (numwords <= 0)
+		return numwords;
 
 	/* convert, but if dst == NULL, simulate */
-	if (dst != NULL) {
-		src = acm->block + acm->block_pos;
-		gotbytes = output_values(src, (unsigned char*)dst, numwords,
-				acm->info.acm_level,
-				bigendianp, wordlen, sgned);
-	} else
-		gotbytes = numwords * wordlen;
+	if (dst == NULL)
+		return numwords * wordlen;
+	return output_values(acm, src, (unsigned char*)dst, numwords,
+			     bigendianp, wordlen, sgned);
+}
+
+/*
+ * Give pointer to decoded values in current block, without copying.
+ * Values are scaled by 2^acm_level, shift right by it for 16-bit.
+ * Count is not rounded to frames, so a frame may span two calls.
+ * Pointer is valid until next read or seek.  Returns word count.
+ */
+int acm_read_block_ptr(ACMStream *acm, const int **data, unsigned maxwords)
+{
+	return take_words(acm, maxwords, 0, data);
+}
 
-	if (gotbytes >= 0) {
-		acm->stream_pos += numwords;
-		acm->block_pos += numwords;
-		if (acm->block_pos == acm->block_len)
-			acm->block_ready = 0;
+/*
+ * Read normalized floats in [-1, 1), full precision of decoded
+ * values is kept.  Like acm_read(), at most one block per call.
+ * Returns word count.
+ */
+int acm_read_float(ACMStream *acm, float *dst, unsigned maxwords)
+{
+	const int *src;
+	float scale;
+	int i, numwords;
+
+	numwords = take_words(acm, maxwords, 1, &src);
+	if (numwords <= 0)
+		return numwords;
+
+	scale = 1.0f / (float)(32768u << acm->info.acm_level);
+	ACM_STAT_START(acm);
+	if (dst != NULL)
+		for (i = 0; i < numwords; i++)
+			dst[i] = src[i] * scale;
+	ACM_STAT_TIME(acm, output_ns);
+
+	return numwords;
+}
+
+/*
+ * Read up to nframes frames in given format, across blocks.
+ * For planar fmt, dst is void *[planes], one buffer per channel;
+ * mono streams may ask for more planes, they get the same data.
+ * dst may be NULL to skip.  Returns frames read, 0 on EOF or
+ * error code if nothing was read.
+ */
+int acm_read_frames(ACMStream *acm, void *dst, unsigned nframes, const ACMFormat *fmt)
+{
+	unsigned chans = acm->info.channels, shift = acm->info.acm_level;
+	unsigned got = 0, nplanes = 0, size, n;
+	acm_frames_func func = NULL;
+	acm_planar_func pfunc = NULL;
+	const int *src;
+	int res;
+
+	if (fmt->sample >= ACM_SAMPLE_COUNT)
+		return ACM_ERR_BADFMT;
+	size = sample_size[fmt->sample];
+	if (fmt->planar) {
+		nplanes = fmt->planes ? fmt->planes : chans;
+		if (chans > 1 && nplanes != chans)
+			return ACM_ERR_BADFMT;
+		if (nplanes == 2)
+			pfunc = acm->planar2_func[fmt->sample];
+		else
+			pfunc = acm->planar_func[fmt->sample];
+	} else {
+		func = acm->frames_func[fmt->sample];
 	}
 
-	return gotbytes;
+	while (got < nframes) {
+		res = take_words(acm, (nframes - got) * chans, 1, &src);
+		if (res <= 0) {
+			if (got > 0)
+				break;
+			return res;
+		}
+		n = res / chans;
+
+		ACM_STAT_START(acm);
+		if (dst == NULL) {
+			/* skip */
+		} else if (pfunc) {
+			pfunc(src, chans, (void **)dst, nplanes, got, n, shift);
+		} else {
+			func(src, (unsigned char *)dst + (size_t)got * chans * size,
+			     n * chans, shift);
+		}
+		ACM_STAT_TIME(acm, output_ns);
+
+		got += n;
+	}
+	return got;
 }
 
 void acm_close(ACMStream *acm)
@@ -907,14 +2210,12 @@ void acm_close(ACMStream *acm)
 		return;
 	if (acm->io.close_func)
 		acm->io.close_func(acm->io_arg);
-	if (acm->buf)
-		free(acm->buf);
-	if (acm->block)
-		free(acm->block);
-	if (acm->wrapbuf)
-		free(acm->wrapbuf);
-	if (acm->ampbuf)
-		free(acm->ampbuf);
-	free(acm);
+	acm_mem_free(acm, acm->buf);
+	if (acm->pcm_data == NULL)
+		acm_mem_free(acm, acm->block);
+	acm_mem_free(acm, acm->wrapbuf);
+	acm_mem_free(acm, acm->tile);
+	acm_free_seek_index(acm);
+	acm_mem_free(acm, acm);
 }
 
@@ -0,0 +1,373 @@
+/* Generated by gentables.c, do not edit. */
+
+#define FILL_PEEK_BITS	8
+#define FILL_MAX_VALS	6
+
+static const uint32_t tab_k13[1 << FILL_PEEK_BITS] = {
+	0x63444444, 0x54044444, 0x54044444, 0x55044443, 0x54044444, 0x66444444,
+	0x55044344, 0x55044445, 0x63444444, 0x66444444, 0x66444444, 0x67444443,
+	0x55034444, 0x67444434, 0x55044544, 0x67444445, 0x63444444, 0x66444444,
+	0x66444444, 0x67444443, 0x66444444, 0x57044444, 0x67444344, 0x67444445,
+	0x63444444, 0x67443444, 0x67443444, 0x68444433, 0x55054444, 0x67444454,
+	0x67444544, 0x68444435, 0x63444444, 0x54044444, 0x54044444, 0x67444443,
+	0x54044444, 0x57044444, 0x67444344, 0x67444445, 0x63444444, 0x57044444,
+	0x57044444, 0x58044443, 0x67434444, 0x58044434, 0x67444544, 0x58044445,
+	0x63444444, 0x67344444, 0x67344444, 0x68443443, 0x67344444, 0x58044344,
+	0x68443344, 0x68443445, 0x63444444, 0x67445444, 0x67445444, 0x68444453,
+	0x67454444, 0x58044454, 0x68443544, 0x68444455, 0x63444444, 0x54044444,
+	0x54044444, 0x55044443, 0x54044444, 0x66444444, 0x55044344, 0x55044445,
+	0x63444444, 0x66444444, 0x66444444, 0x58044443, 0x55034444, 0x58044434,
+	0x55044544, 0x58044445, 0x63444444, 0x66444444, 0x66444444, 0x58044443,
+	0x66444444, 0x48004444, 0x58044344, 0x58044445, 0x63444444, 0x58043444,
+	0x58043444, 0x38000433, 0x55054444, 0x58044454, 0x58044544, 0x38000435,
+	0x63444444, 0x54044444, 0x54044444, 0x68344443, 0x54044444, 0x58034444,
+	0x68344344, 0x68344445, 0x63444444, 0x58034444, 0x58034444, 0x38000343,
+	0x68334444, 0x38000334, 0x68344544, 0x38000345, 0x63444444, 0x67544444,
+	0x67544444, 0x68445443, 0x67544444, 0x58044544, 0x68445344, 0x68445445,
+	0x63444444, 0x58045444, 0x58045444, 0x38000453, 0x68354444, 0x38000354,
+	0x68445544, 0x38000455, 0x63444444, 0x54044444, 0x54044444, 0x55044443,
+	0x54044444, 0x66444444, 0x55044344, 0x55044445, 0x63444444, 0x66444444,
+	0x66444444, 0x67444443, 0x55034444, 0x67444434, 0x55044544, 0x67444445,
+	0x63444444, 0x66444444, 0x66444444, 0x67444443, 0x66444444, 0x57044444,
+	0x67444344, 0x67444445, 0x63444444, 0x67443444, 0x67443444, 0x47004433,
+	0x55054444, 0x67444454, 0x67444544, 0x47004435, 0x63444444, 0x54044444,
+	0x54044444, 0x67444443, 0x54044444, 0x57044444, 0x67444344, 0x67444445,
+	0x63444444, 0x57044444, 0x57044444, 0x37000443, 0x67434444, 0x37000434,
+	0x67444544, 0x37000445, 0x63444444, 0x67344444, 0x67344444, 0x47003443,
+	0x67344444, 0x37000344, 0x47003344, 0x47003445, 0x63444444, 0x67445444,
+	0x67445444, 0x47004453, 0x67454444, 0x37000454, 0x47003544, 0x47004455,
+	0x63444444, 0x54044444, 0x54044444, 0x55044443, 0x54044444, 0x66444444,
+	0x55044344, 0x55044445, 0x63444444, 0x66444444, 0x66444444, 0x46004443,
+	0x55034444, 0x46004434, 0x55044544, 0x46004445, 0x63444444, 0x66444444,
+	0x66444444, 0x46004443, 0x66444444, 0x36000444, 0x46004344, 0x46004445,
+	0x63444444, 0x46003444, 0x46003444, 0x26000033, 0x55054444, 0x46004454,
+	0x46004544, 0x26000035, 0x63444444, 0x54044444, 0x54044444, 0x68544443,
+	0x54044444, 0x58054444, 0x68544344, 0x68544445, 0x63444444, 0x58054444,
+	0x58054444, 0x38000543, 0x68534444, 0x38000534, 0x68544544, 0x38000545,
+	0x63444444, 0x67544444, 0x67544444, 0x47005443, 0x67544444, 0x37000544,
+	0x47005344, 0x47005445, 0x63444444, 0x46005444, 0x46005444, 0x26000053,
+	0x68554444, 0x38000554, 0x47005544, 0x26000055,
+};
+
+static const uint32_t tab_k12[1 << FILL_PEEK_BITS] = {
+	0x66444444, 0x67444443, 0x67444434, 0x67444445, 0x67444344, 0x68444433,
+	0x67444454, 0x68444435, 0x67443444, 0x68444343, 0x68444334, 0x68444345,
+	0x67444544, 0x68444453, 0x68444354, 0x68444455, 0x67434444, 0x68443443,
+	0x68443434, 0x68443445, 0x68443344, 0x58044333, 0x68443454, 0x58044335,
+	0x67445444, 0x68444543, 0x68444534, 0x68444545, 0x68443544, 0x58044353,
+	0x68444554, 0x58044355, 0x67344444, 0x68434443, 0x68434434, 0x68434445,
+	0x68434344, 0x58043433, 0x68434454, 0x58043435, 0x68433444, 0x58043343,
+	0x58043334, 0x58043345, 0x68434544, 0x58043453, 0x58043354, 0x58043455,
+	0x67454444, 0x68445443, 0x68445434, 0x68445445, 0x68445344, 0x58044533,
+	0x68445454, 0x58044535, 0x68435444, 0x58043543, 0x58043534, 0x58043545,
+	0x68445544, 0x58044553, 0x58043554, 0x58044555, 0x66444444, 0x68344443,
+	0x68344434, 0x68344445, 0x68344344, 0x58034433, 0x68344454, 0x58034435,
+	0x68343444, 0x58034343, 0x58034334, 0x58034345, 0x68344544, 0x58034453,
+	0x58034354, 0x58034455, 0x68334444, 0x58033443, 0x58033434, 0x58033445,
+	0x58033344, 0x48003333, 0x58033454, 0x48003335, 0x68345444, 0x58034543,
+	0x58034534, 0x58034545, 0x58033544, 0x48003353, 0x58034554, 0x48003355,
+	0x67544444, 0x68454443, 0x68454434, 0x68454445, 0x68454344, 0x58045433,
+	0x68454454, 0x58045435, 0x68453444, 0x58045343, 0x58045334, 0x58045345,
+	0x68454544, 0x58045453, 0x58045354, 0x58045455, 0x68354444, 0x58035443,
+	0x58035434, 0x58035445, 0x58035344, 0x48003533, 0x58035454, 0x48003535,
+	0x68455444, 0x58045543, 0x58045534, 0x58045545, 0x58035544, 0x48003553,
+	0x58045554, 0x48003555, 0x66444444, 0x67444443, 0x67444434, 0x67444445,
+	0x67444344, 0x57044433, 0x67444454, 0x57044435, 0x67443444, 0x57044343,
+	0x57044334, 0x57044345, 0x67444544, 0x57044453, 0x57044354, 0x57044455,
+	0x67434444, 0x57043443, 0x57043434, 0x57043445, 0x57043344, 0x47004333,
+	0x57043454, 0x47004335, 0x67445444, 0x57044543, 0x57044534, 0x57044545,
+	0x57043544, 0x47004353, 0x57044554, 0x47004355, 0x67344444, 0x57034443,
+	0x57034434, 0x57034445, 0x57034344, 0x47003433, 0x57034454, 0x47003435,
+	0x57033444, 0x47003343, 0x47003334, 0x47003345, 0x57034544, 0x47003453,
+	0x47003354, 0x47003455, 0x67454444, 0x57045443, 0x57045434, 0x57045445,
+	0x57045344, 0x47004533, 0x57045454, 0x47004535, 0x57035444, 0x47003543,
+	0x47003534, 0x47003545, 0x57045544, 0x47004553, 0x47003554, 0x47004555,
+	0x66444444, 0x68544443, 0x68544434, 0x68544445, 0x68544344, 0x58054433,
+	0x68544454, 0x58054435, 0x68543444, 0x58054343, 0x58054334, 0x58054345,
+	0x68544544, 0x58054453, 0x58054354, 0x58054455, 0x68534444, 0x58053443,
+	0x58053434, 0x58053445, 0x58053344, 0x48005333, 0x58053454, 0x48005335,
+	0x68545444, 0x58054543, 0x58054534, 0x58054545, 0x58053544, 0x48005353,
+	0x58054554, 0x48005355, 0x67544444, 0x57054443, 0x57054434, 0x57054445,
+	0x57054344, 0x47005433, 0x57054454, 0x47005435, 0x57053444, 0x47005343,
+	0x47005334, 0x47005345, 0x57054544, 0x47005453, 0x47005354, 0x47005455,
+	0x68554444, 0x58055443, 0x58055434, 0x58055445, 0x58055344, 0x48005533,
+	0x58055454, 0x48005535, 0x57055444, 0x47005543, 0x47005534, 0x47005545,
+	0x58055544, 0x48005553, 0x47005554, 0x48005555,
+};
+
+static const uint32_t tab_k24[1 << FILL_PEEK_BITS] = {
+	0x63444444, 0x54044444, 0x54044444, 0x56044442, 0x54044444, 0x66444444,
+	0x56044244, 0x56044443, 0x63444444, 0x66444444, 0x66444444, 0x56044445,
+	0x56024444, 0x68444424, 0x56044344, 0x56044446, 0x63444444, 0x66444444,
+	0x66444444, 0x68444442, 0x66444444, 0x57044444, 0x56044544, 0x68444443,
+	0x63444444, 0x68442444, 0x68442444, 0x68444445, 0x56034444, 0x68444434,
+	0x56044644, 0x68444446, 0x63444444, 0x54044444, 0x54044444, 0x68444442,
+	0x54044444, 0x57044444, 0x68444244, 0x68444443, 0x63444444, 0x57044444,
+	0x57044444, 0x68444445, 0x56054444, 0x68444454, 0x68444344, 0x68444446,
+	0x63444444, 0x68244444, 0x68244444, 0x28000022, 0x68244444, 0x38000244,
+	0x68444544, 0x28000023, 0x63444444, 0x68443444, 0x68443444, 0x28000025,
+	0x56064444, 0x68444464, 0x68444644, 0x28000026, 0x63444444, 0x54044444,
+	0x54044444, 0x68444442, 0x54044444, 0x66444444, 0x68444244, 0x68444443,
+	0x63444444, 0x66444444, 0x66444444, 0x68444445, 0x68424444, 0x38000424,
+	0x68444344, 0x68444446, 0x63444444, 0x66444444, 0x66444444, 0x38000442,
+	0x66444444, 0x48004444, 0x68444544, 0x38000443, 0x63444444, 0x68445444,
+	0x68445444, 0x38000445, 0x68434444, 0x38000434, 0x68444644, 0x38000446,
+	0x63444444, 0x54044444, 0x54044444, 0x35000442, 0x54044444, 0x45004444,
+	0x35000244, 0x35000443, 0x63444444, 0x45004444, 0x45004444, 0x35000445,
+	0x68454444, 0x38000454, 0x35000344, 0x35000446, 0x63444444, 0x68344444,
+	0x68344444, 0x28000032, 0x68344444, 0x38000344, 0x35000544, 0x28000033,
+	0x63444444, 0x68446444, 0x68446444, 0x28000035, 0x68464444, 0x38000464,
+	0x35000644, 0x28000036, 0x63444444, 0x54044444, 0x54044444, 0x56044442,
+	0x54044444, 0x66444444, 0x56044244, 0x56044443, 0x63444444, 0x66444444,
+	0x66444444, 0x56044445, 0x56024444, 0x47004424, 0x56044344, 0x56044446,
+	0x63444444, 0x66444444, 0x66444444, 0x47004442, 0x66444444, 0x57044444,
+	0x56044544, 0x47004443, 0x63444444, 0x47002444, 0x47002444, 0x47004445,
+	0x56034444, 0x47004434, 0x56044644, 0x47004446, 0x63444444, 0x54044444,
+	0x54044444, 0x47004442, 0x54044444, 0x57044444, 0x47004244, 0x47004443,
+	0x63444444, 0x57044444, 0x57044444, 0x47004445, 0x56054444, 0x47004454,
+	0x47004344, 0x47004446, 0x63444444, 0x68544444, 0x68544444, 0x28000052,
+	0x68544444, 0x38000544, 0x47004544, 0x28000053, 0x63444444, 0x47003444,
+	0x47003444, 0x28000055, 0x56064444, 0x47004464, 0x47004644, 0x28000056,
+	0x63444444, 0x54044444, 0x54044444, 0x56044442, 0x54044444, 0x66444444,
+	0x56044244, 0x56044443, 0x63444444, 0x66444444, 0x66444444, 0x56044445,
+	0x56024444, 0x26000024, 0x56044344, 0x56044446, 0x63444444, 0x66444444,
+	0x66444444, 0x26000042, 0x66444444, 0x36000444, 0x56044544, 0x26000043,
+	0x63444444, 0x47005444, 0x47005444, 0x26000045, 0x56034444, 0x26000034,
+	0x56044644, 0x26000046, 0x63444444, 0x54044444, 0x54044444, 0x35000442,
+	0x54044444, 0x45004444, 0x35000244, 0x35000443, 0x63444444, 0x45004444,
+	0x45004444, 0x35000445, 0x56054444, 0x26000054, 0x35000344, 0x35000446,
+	0x63444444, 0x68644444, 0x68644444, 0x28000062, 0x68644444, 0x38000644,
+	0x35000544, 0x28000063, 0x63444444, 0x47006444, 0x47006444, 0x28000065,
+	0x56064444, 0x26000064, 0x35000644, 0x28000066,
+};
+
+static const uint32_t tab_k23[1 << FILL_PEEK_BITS] = {
+	0x66444444, 0x68444442, 0x68444424, 0x68444443, 0x68444244, 0x68444445,
+	0x68444434, 0x68444446, 0x68442444, 0x48004422, 0x68444454, 0x48004423,
+	0x68444344, 0x48004425, 0x68444464, 0x48004426, 0x68424444, 0x48004242,
+	0x48004224, 0x48004243, 0x68444544, 0x48004245, 0x48004234, 0x48004246,
+	0x68443444, 0x48004432, 0x48004254, 0x48004433, 0x68444644, 0x48004435,
+	0x48004264, 0x48004436, 0x68244444, 0x48002442, 0x48002424, 0x48002443,
+	0x48002244, 0x48002445, 0x48002434, 0x48002446, 0x68445444, 0x48004452,
+	0x48002454, 0x48004453, 0x48002344, 0x48004455, 0x48002464, 0x48004456,
+	0x68434444, 0x48004342, 0x48004324, 0x48004343, 0x48002544, 0x48004345,
+	0x48004334, 0x48004346, 0x68446444, 0x48004462, 0x48004354, 0x48004463,
+	0x48002644, 0x48004465, 0x48004364, 0x48004466, 0x66444444, 0x46004442,
+	0x46004424, 0x46004443, 0x46004244, 0x46004445, 0x46004434, 0x46004446,
+	0x46002444, 0x26000022, 0x46004454, 0x26000023, 0x46004344, 0x26000025,
+	0x46004464, 0x26000026, 0x68454444, 0x48004542, 0x48004524, 0x48004543,
+	0x46004544, 0x48004545, 0x48004534, 0x48004546, 0x46003444, 0x26000032,
+	0x48004554, 0x26000033, 0x46004644, 0x26000035, 0x48004564, 0x26000036,
+	0x68344444, 0x48003442, 0x48003424, 0x48003443, 0x48003244, 0x48003445,
+	0x48003434, 0x48003446, 0x46005444, 0x26000052, 0x48003454, 0x26000053,
+	0x48003344, 0x26000055, 0x48003464, 0x26000056, 0x68464444, 0x48004642,
+	0x48004624, 0x48004643, 0x48003544, 0x48004645, 0x48004634, 0x48004646,
+	0x46006444, 0x26000062, 0x48004654, 0x26000063, 0x48003644, 0x26000065,
+	0x48004664, 0x26000066, 0x66444444, 0x57044442, 0x57044424, 0x57044443,
+	0x57044244, 0x57044445, 0x57044434, 0x57044446, 0x57042444, 0x37000422,
+	0x57044454, 0x37000423, 0x57044344, 0x37000425, 0x57044464, 0x37000426,
+	0x57024444, 0x37000242, 0x37000224, 0x37000243, 0x57044544, 0x37000245,
+	0x37000234, 0x37000246, 0x57043444, 0x37000432, 0x37000254, 0x37000433,
+	0x57044644, 0x37000435, 0x37000264, 0x37000436, 0x68544444, 0x48005442,
+	0x48005424, 0x48005443, 0x48005244, 0x48005445, 0x48005434, 0x48005446,
+	0x57045444, 0x37000452, 0x48005454, 0x37000453, 0x48005344, 0x37000455,
+	0x48005464, 0x37000456, 0x57034444, 0x37000342, 0x37000324, 0x37000343,
+	0x48005544, 0x37000345, 0x37000334, 0x37000346, 0x57046444, 0x37000462,
+	0x37000354, 0x37000463, 0x48005644, 0x37000465, 0x37000364, 0x37000466,
+	0x66444444, 0x46004442, 0x46004424, 0x46004443, 0x46004244, 0x46004445,
+	0x46004434, 0x46004446, 0x46002444, 0x26000022, 0x46004454, 0x26000023,
+	0x46004344, 0x26000025, 0x46004464, 0x26000026, 0x57054444, 0x37000542,
+	0x37000524, 0x37000543, 0x46004544, 0x37000545, 0x37000534, 0x37000546,
+	0x46003444, 0x26000032, 0x37000554, 0x26000033, 0x46004644, 0x26000035,
+	0x37000564, 0x26000036, 0x68644444, 0x48006442, 0x48006424, 0x48006443,
+	0x48006244, 0x48006445, 0x48006434, 0x48006446, 0x46005444, 0x26000052,
+	0x48006454, 0x26000053, 0x48006344, 0x26000055, 0x48006464, 0x26000056,
+	0x57064444, 0x37000642, 0x37000624, 0x37000643, 0x48006544, 0x37000645,
+	0x37000634, 0x37000646, 0x46006444, 0x26000062, 0x37000654, 0x26000063,
+	0x48006644, 0x26000065, 0x37000664, 0x26000066,
+};
+
+static const uint32_t tab_k35[1 << FILL_PEEK_BITS] = {
+	0x63444444, 0x54044444, 0x54044444, 0x56044443, 0x54044444, 0x66444444,
+	0x56044344, 0x57044441, 0x63444444, 0x66444444, 0x66444444, 0x56044445,
+	0x56034444, 0x68444434, 0x57044144, 0x57044442, 0x63444444, 0x66444444,
+	0x66444444, 0x68444443, 0x66444444, 0x57044444, 0x56044544, 0x57044446,
+	0x63444444, 0x68443444, 0x68443444, 0x68444445, 0x57014444, 0x48004414,
+	0x57044244, 0x57044447, 0x63444444, 0x54044444, 0x54044444, 0x68444443,
+	0x54044444, 0x57044444, 0x68444344, 0x48004441, 0x63444444, 0x57044444,
+	0x57044444, 0x68444445, 0x56054444, 0x68444454, 0x57044644, 0x48004442,
+	0x63444444, 0x68344444, 0x68344444, 0x28000033, 0x68344444, 0x38000344,
+	0x68444544, 0x48004446, 0x63444444, 0x48001444, 0x48001444, 0x28000035,
+	0x57024444, 0x48004424, 0x57044744, 0x48004447, 0x63444444, 0x54044444,
+	0x54044444, 0x68444443, 0x54044444, 0x66444444, 0x68444344, 0x48004441,
+	0x63444444, 0x66444444, 0x66444444, 0x68444445, 0x68434444, 0x38000434,
+	0x48004144, 0x48004442, 0x63444444, 0x66444444, 0x66444444, 0x38000443,
+	0x66444444, 0x48004444, 0x68444544, 0x48004446, 0x63444444, 0x68445444,
+	0x68445444, 0x38000445, 0x57064444, 0x48004464, 0x48004244, 0x48004447,
+	0x63444444, 0x54044444, 0x54044444, 0x35000443, 0x54044444, 0x45004444,
+	0x35000344, 0x15000001, 0x63444444, 0x45004444, 0x45004444, 0x35000445,
+	0x68454444, 0x38000454, 0x48004644, 0x15000002, 0x63444444, 0x54044444,
+	0x54044444, 0x14000003, 0x54044444, 0x24000044, 0x35000544, 0x15000006,
+	0x63444444, 0x48002444, 0x48002444, 0x14000005, 0x57074444, 0x48004474,
+	0x48004744, 0x15000007, 0x63444444, 0x54044444, 0x54044444, 0x56044443,
+	0x54044444, 0x66444444, 0x56044344, 0x57044441, 0x63444444, 0x66444444,
+	0x66444444, 0x56044445, 0x56034444, 0x47004434, 0x57044144, 0x57044442,
+	0x63444444, 0x66444444, 0x66444444, 0x47004443, 0x66444444, 0x57044444,
+	0x56044544, 0x57044446, 0x63444444, 0x47003444, 0x47003444, 0x47004445,
+	0x57014444, 0x27000014, 0x57044244, 0x57044447, 0x63444444, 0x54044444,
+	0x54044444, 0x47004443, 0x54044444, 0x57044444, 0x47004344, 0x27000041,
+	0x63444444, 0x57044444, 0x57044444, 0x47004445, 0x56054444, 0x47004454,
+	0x57044644, 0x27000042, 0x63444444, 0x68544444, 0x68544444, 0x28000053,
+	0x68544444, 0x38000544, 0x47004544, 0x27000046, 0x63444444, 0x48006444,
+	0x48006444, 0x28000055, 0x57024444, 0x27000024, 0x57044744, 0x27000047,
+	0x63444444, 0x54044444, 0x54044444, 0x56044443, 0x54044444, 0x66444444,
+	0x56044344, 0x36000441, 0x63444444, 0x66444444, 0x66444444, 0x56044445,
+	0x56034444, 0x26000034, 0x36000144, 0x36000442, 0x63444444, 0x66444444,
+	0x66444444, 0x26000043, 0x66444444, 0x36000444, 0x56044544, 0x36000446,
+	0x63444444, 0x47005444, 0x47005444, 0x26000045, 0x57064444, 0x27000064,
+	0x36000244, 0x36000447, 0x63444444, 0x54044444, 0x54044444, 0x35000443,
+	0x54044444, 0x45004444, 0x35000344, 0x15000001, 0x63444444, 0x45004444,
+	0x45004444, 0x35000445, 0x56054444, 0x26000054, 0x36000644, 0x15000002,
+	0x63444444, 0x54044444, 0x54044444, 0x14000003, 0x54044444, 0x24000044,
+	0x35000544, 0x15000006, 0x63444444, 0x48007444, 0x48007444, 0x14000005,
+	0x57074444, 0x27000074, 0x36000744, 0x15000007,
+};
+
+static const uint32_t tab_k34[1 << FILL_PEEK_BITS] = {
+	0x66444444, 0x68444443, 0x68444434, 0x58044441, 0x68444344, 0x68444445,
+	0x58044414, 0x58044442, 0x68443444, 0x48004433, 0x68444454, 0x58044446,
+	0x58044144, 0x48004435, 0x58044424, 0x58044447, 0x68434444, 0x48004343,
+	0x48004334, 0x38000431, 0x68444544, 0x48004345, 0x58044464, 0x38000432,
+	0x58041444, 0x38000413, 0x48004354, 0x38000436, 0x58044244, 0x38000415,
+	0x58044474, 0x38000437, 0x68344444, 0x48003443, 0x48003434, 0x38000341,
+	0x48003344, 0x48003445, 0x38000314, 0x38000342, 0x68445444, 0x48004453,
+	0x48003454, 0x38000346, 0x58044644, 0x48004455, 0x38000324, 0x38000347,
+	0x58014444, 0x38000143, 0x38000134, 0x28000011, 0x48003544, 0x38000145,
+	0x38000364, 0x28000012, 0x58042444, 0x38000423, 0x38000154, 0x28000016,
+	0x58044744, 0x38000425, 0x38000374, 0x28000017, 0x66444444, 0x46004443,
+	0x46004434, 0x36000441, 0x46004344, 0x46004445, 0x36000414, 0x36000442,
+	0x46003444, 0x26000033, 0x46004454, 0x36000446, 0x36000144, 0x26000035,
+	0x36000424, 0x36000447, 0x68454444, 0x48004543, 0x48004534, 0x38000451,
+	0x46004544, 0x48004545, 0x36000464, 0x38000452, 0x58046444, 0x38000463,
+	0x48004554, 0x38000456, 0x36000244, 0x38000465, 0x36000474, 0x38000457,
+	0x55044444, 0x35000443, 0x35000434, 0x25000041, 0x35000344, 0x35000445,
+	0x25000014, 0x25000042, 0x46005444, 0x26000053, 0x35000454, 0x25000046,
+	0x36000644, 0x26000055, 0x25000024, 0x25000047, 0x58024444, 0x38000243,
+	0x38000234, 0x28000021, 0x35000544, 0x38000245, 0x25000064, 0x28000022,
+	0x58047444, 0x38000473, 0x38000254, 0x28000026, 0x36000744, 0x38000475,
+	0x25000074, 0x28000027, 0x66444444, 0x57044443, 0x57044434, 0x47004441,
+	0x57044344, 0x57044445, 0x47004414, 0x47004442, 0x57043444, 0x37000433,
+	0x57044454, 0x47004446, 0x47004144, 0x37000435, 0x47004424, 0x47004447,
+	0x57034444, 0x37000343, 0x37000334, 0x27000031, 0x57044544, 0x37000345,
+	0x47004464, 0x27000032, 0x47001444, 0x27000013, 0x37000354, 0x27000036,
+	0x47004244, 0x27000015, 0x47004474, 0x27000037, 0x68544444, 0x48005443,
+	0x48005434, 0x38000541, 0x48005344, 0x48005445, 0x38000514, 0x38000542,
+	0x57045444, 0x37000453, 0x48005454, 0x38000546, 0x47004644, 0x37000455,
+	0x38000524, 0x38000547, 0x58064444, 0x38000643, 0x38000634, 0x28000061,
+	0x48005544, 0x38000645, 0x38000564, 0x28000062, 0x47002444, 0x27000023,
+	0x38000654, 0x28000066, 0x47004744, 0x27000025, 0x38000574, 0x28000067,
+	0x66444444, 0x46004443, 0x46004434, 0x36000441, 0x46004344, 0x46004445,
+	0x36000414, 0x36000442, 0x46003444, 0x26000033, 0x46004454, 0x36000446,
+	0x36000144, 0x26000035, 0x36000424, 0x36000447, 0x57054444, 0x37000543,
+	0x37000534, 0x27000051, 0x46004544, 0x37000545, 0x36000464, 0x27000052,
+	0x47006444, 0x27000063, 0x37000554, 0x27000056, 0x36000244, 0x27000065,
+	0x36000474, 0x27000057, 0x55044444, 0x35000443, 0x35000434, 0x25000041,
+	0x35000344, 0x35000445, 0x25000014, 0x25000042, 0x46005444, 0x26000053,
+	0x35000454, 0x25000046, 0x36000644, 0x26000055, 0x25000024, 0x25000047,
+	0x58074444, 0x38000743, 0x38000734, 0x28000071, 0x35000544, 0x38000745,
+	0x25000064, 0x28000072, 0x47007444, 0x27000073, 0x38000754, 0x28000076,
+	0x36000744, 0x27000075, 0x25000074, 0x28000077,
+};
+
+static const uint32_t tab_k45[1 << FILL_PEEK_BITS] = {
+	0x63444444, 0x54044444, 0x54044444, 0x57044440, 0x54044444, 0x66444444,
+	0x57044044, 0x57044441, 0x63444444, 0x66444444, 0x66444444, 0x57044442,
+	0x57004444, 0x48004404, 0x57044144, 0x57044443, 0x63444444, 0x66444444,
+	0x66444444, 0x57044445, 0x66444444, 0x57044444, 0x57044244, 0x57044446,
+	0x63444444, 0x48000444, 0x48000444, 0x57044447, 0x57014444, 0x48004414,
+	0x57044344, 0x57044448, 0x63444444, 0x54044444, 0x54044444, 0x48004440,
+	0x54044444, 0x57044444, 0x57044544, 0x48004441, 0x63444444, 0x57044444,
+	0x57044444, 0x48004442, 0x57024444, 0x48004424, 0x57044644, 0x48004443,
+	0x63444444, 0x54044444, 0x54044444, 0x48004445, 0x54044444, 0x24000044,
+	0x57044744, 0x48004446, 0x63444444, 0x48001444, 0x48001444, 0x48004447,
+	0x57034444, 0x48004434, 0x57044844, 0x48004448, 0x63444444, 0x54044444,
+	0x54044444, 0x48004440, 0x54044444, 0x66444444, 0x48004044, 0x48004441,
+	0x63444444, 0x66444444, 0x66444444, 0x48004442, 0x57054444, 0x48004454,
+	0x48004144, 0x48004443, 0x63444444, 0x66444444, 0x66444444, 0x48004445,
+	0x66444444, 0x48004444, 0x48004244, 0x48004446, 0x63444444, 0x48002444,
+	0x48002444, 0x48004447, 0x57064444, 0x48004464, 0x48004344, 0x48004448,
+	0x63444444, 0x54044444, 0x54044444, 0x15000000, 0x54044444, 0x45004444,
+	0x48004544, 0x15000001, 0x63444444, 0x45004444, 0x45004444, 0x15000002,
+	0x57074444, 0x48004474, 0x48004644, 0x15000003, 0x63444444, 0x54044444,
+	0x54044444, 0x15000005, 0x54044444, 0x24000044, 0x48004744, 0x15000006,
+	0x63444444, 0x48003444, 0x48003444, 0x15000007, 0x57084444, 0x48004484,
+	0x48004844, 0x15000008, 0x63444444, 0x54044444, 0x54044444, 0x57044440,
+	0x54044444, 0x66444444, 0x57044044, 0x57044441, 0x63444444, 0x66444444,
+	0x66444444, 0x57044442, 0x57004444, 0x27000004, 0x57044144, 0x57044443,
+	0x63444444, 0x66444444, 0x66444444, 0x57044445, 0x66444444, 0x57044444,
+	0x57044244, 0x57044446, 0x63444444, 0x48005444, 0x48005444, 0x57044447,
+	0x57014444, 0x27000014, 0x57044344, 0x57044448, 0x63444444, 0x54044444,
+	0x54044444, 0x27000040, 0x54044444, 0x57044444, 0x57044544, 0x27000041,
+	0x63444444, 0x57044444, 0x57044444, 0x27000042, 0x57024444, 0x27000024,
+	0x57044644, 0x27000043, 0x63444444, 0x54044444, 0x54044444, 0x27000045,
+	0x54044444, 0x24000044, 0x57044744, 0x27000046, 0x63444444, 0x48006444,
+	0x48006444, 0x27000047, 0x57034444, 0x27000034, 0x57044844, 0x27000048,
+	0x63444444, 0x54044444, 0x54044444, 0x36000440, 0x54044444, 0x66444444,
+	0x36000044, 0x36000441, 0x63444444, 0x66444444, 0x66444444, 0x36000442,
+	0x57054444, 0x27000054, 0x36000144, 0x36000443, 0x63444444, 0x66444444,
+	0x66444444, 0x36000445, 0x66444444, 0x36000444, 0x36000244, 0x36000446,
+	0x63444444, 0x48007444, 0x48007444, 0x36000447, 0x57064444, 0x27000064,
+	0x36000344, 0x36000448, 0x63444444, 0x54044444, 0x54044444, 0x15000000,
+	0x54044444, 0x45004444, 0x36000544, 0x15000001, 0x63444444, 0x45004444,
+	0x45004444, 0x15000002, 0x57074444, 0x27000074, 0x36000644, 0x15000003,
+	0x63444444, 0x54044444, 0x54044444, 0x15000005, 0x54044444, 0x24000044,
+	0x36000744, 0x15000006, 0x63444444, 0x48008444, 0x48008444, 0x15000007,
+	0x57084444, 0x27000084, 0x36000844, 0x15000008,
+};
+
+static const uint32_t tab_k44[1 << FILL_PEEK_BITS] = {
+	0x66444444, 0x58044440, 0x58044404, 0x58044441, 0x58044044, 0x58044442,
+	0x58044414, 0x58044443, 0x58040444, 0x58044445, 0x58044424, 0x58044446,
+	0x58044144, 0x58044447, 0x58044434, 0x58044448, 0x58004444, 0x28000000,
+	0x58044454, 0x28000001, 0x58044244, 0x28000002, 0x58044464, 0x28000003,
+	0x58041444, 0x28000005, 0x58044474, 0x28000006, 0x58044344, 0x28000007,
+	0x58044484, 0x28000008, 0x55044444, 0x25000040, 0x25000004, 0x25000041,
+	0x58044544, 0x25000042, 0x25000014, 0x25000043, 0x58042444, 0x25000045,
+	0x25000024, 0x25000046, 0x58044644, 0x25000047, 0x25000034, 0x25000048,
+	0x58014444, 0x28000010, 0x25000054, 0x28000011, 0x58044744, 0x28000012,
+	0x25000064, 0x28000013, 0x58043444, 0x28000015, 0x25000074, 0x28000016,
+	0x58044844, 0x28000017, 0x25000084, 0x28000018, 0x66444444, 0x36000440,
+	0x36000404, 0x36000441, 0x36000044, 0x36000442, 0x36000414, 0x36000443,
+	0x58045444, 0x36000445, 0x36000424, 0x36000446, 0x36000144, 0x36000447,
+	0x36000434, 0x36000448, 0x58024444, 0x28000020, 0x36000454, 0x28000021,
+	0x36000244, 0x28000022, 0x36000464, 0x28000023, 0x58046444, 0x28000025,
+	0x36000474, 0x28000026, 0x36000344, 0x28000027, 0x36000484, 0x28000028,
+	0x55044444, 0x25000040, 0x25000004, 0x25000041, 0x36000544, 0x25000042,
+	0x25000014, 0x25000043, 0x58047444, 0x25000045, 0x25000024, 0x25000046,
+	0x36000644, 0x25000047, 0x25000034, 0x25000048, 0x58034444, 0x28000030,
+	0x25000054, 0x28000031, 0x36000744, 0x28000032, 0x25000064, 0x28000033,
+	0x58048444, 0x28000035, 0x25000074, 0x28000036, 0x36000844, 0x28000037,
+	0x25000084, 0x28000038, 0x66444444, 0x47004440, 0x47004404, 0x47004441,
+	0x47004044, 0x47004442, 0x47004414, 0x47004443, 0x47000444, 0x47004445,
+	0x47004424, 0x47004446, 0x47004144, 0x47004447, 0x47004434, 0x47004448,
+	0x58054444, 0x28000050, 0x47004454, 0x28000051, 0x47004244, 0x28000052,
+	0x47004464, 0x28000053, 0x47001444, 0x28000055, 0x47004474, 0x28000056,
+	0x47004344, 0x28000057, 0x47004484, 0x28000058, 0x55044444, 0x25000040,
+	0x25000004, 0x25000041, 0x47004544, 0x25000042, 0x25000014, 0x25000043,
+	0x47002444, 0x25000045, 0x25000024, 0x25000046, 0x47004644, 0x25000047,
+	0x25000034, 0x25000048, 0x58064444, 0x28000060, 0x25000054, 0x28000061,
+	0x47004744, 0x28000062, 0x25000064, 0x28000063, 0x47003444, 0x28000065,
+	0x25000074, 0x28000066, 0x47004844, 0x28000067, 0x25000084, 0x28000068,
+	0x66444444, 0x36000440, 0x36000404, 0x36000441, 0x36000044, 0x36000442,
+	0x36000414, 0x36000443, 0x47005444, 0x36000445, 0x36000424, 0x36000446,
+	0x36000144, 0x36000447, 0x36000434, 0x36000448, 0x58074444, 0x28000070,
+	0x36000454, 0x28000071, 0x36000244, 0x28000072, 0x36000464, 0x28000073,
+	0x47006444, 0x28000075, 0x36000474, 0x28000076, 0x36000344, 0x28000077,
+	0x36000484, 0x28000078, 0x55044444, 0x25000040, 0x25000004, 0x25000041,
+	0x36000544, 0x25000042, 0x25000014, 0x25000043, 0x47007444, 0x25000045,
+	0x25000024, 0x25000046, 0x36000644, 0x25000047, 0x25000034, 0x25000048,
+	0x58084444, 0x28000080, 0x25000054, 0x28000081, 0x36000744, 0x28000082,
+	0x25000064, 0x28000083, 0x47008444, 0x28000085, 0x25000074, 0x28000086,
+	0x36000844, 0x28000087, 0x25000084, 0x28000088,
+};
+
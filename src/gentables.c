@@ -0,0 +1,168 @@
+/*
+ * Generate lookup tables for f_k* fillers.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Usage: gentables > filltab.h
+ *
+ * For each 8-bit window of the bit stream the table gives all
+ * whole symbols that fit in it, see fill_fast() in decode.c.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define PEEK_BITS	8
+#define MAX_VALS	6
+
+static const int map_1bit[] = { -1, +1 };
+static const int map_2bit_near[] = { -2, -1, +1, +2 };
+static const int map_2bit_far[] = { -3, -2, +2, +3 };
+static const int map_3bit[] = { -4, -3, -2, -1, +1, +2, +3, +4 };
+
+struct filler {
+	const char *name;
+	int zero_pair;		/* '0' means 2 zeroes */
+	int kind;		/* code after first 1 bit(s) */
+};
+
+enum { K1, K2N, K3, K_FAR };
+
+static const struct filler filler_list[] = {
+	{ "k13", 1, K1 },
+	{ "k12", 0, K1 },
+	{ "k24", 1, K2N },
+	{ "k23", 0, K2N },
+	{ "k35", 1, K_FAR },
+	{ "k34", 0, K_FAR },
+	{ "k45", 1, K3 },
+	{ "k44", 0, K3 },
+};
+
+/* get bits from window, returns -1 if not enough */
+static int get(unsigned v, int *pos, int bits)
+{
+	int res;
+	if (*pos + bits > PEEK_BITS)
+		return -1;
+	res = (v >> *pos) & ((1 << bits) - 1);
+	*pos += bits;
+	return res;
+}
+
+/* decode one symbol, returns number of values or -1 */
+static int symbol(const struct filler *f, unsigned v, int *pos, int *vals)
+{
+	int b;
+
+	if ((b = get(v, pos, 1)) < 0)
+		return -1;
+	if (b == 0) {
+		vals[0] = vals[1] = 0;
+		return f->zero_pair ? 2 : 1;
+	}
+
+	/* fillers with zero pair have '1, 0' for single zero */
+	if (f->zero_pair) {
+		if ((b = get(v, pos, 1)) < 0)
+			return -1;
+		if (b == 0) {
+			vals[0] = 0;
+			return 1;
+		}
+	}
+
+	switch (f->kind) {
+	case K1:
+		if ((b = get(v, pos, 1)) < 0)
+			return -1;
+		vals[0] = map_1bit[b];
+		return 1;
+	case K2N:
+		if ((b = get(v, pos, 2)) < 0)
+			return -1;
+		vals[0] = map_2bit_near[b];
+		return 1;
+	case K3:
+		if ((b = get(v, pos, 3)) < 0)
+			return -1;
+		vals[0] = map_3bit[b];
+		return 1;
+	case K_FAR:
+		if ((b = get(v, pos, 1)) < 0)
+			return -1;
+		if (b == 0) {
+			if ((b = get(v, pos, 1)) < 0)
+				return -1;
+			vals[0] = map_1bit[b];
+		} else {
+			if ((b = get(v, pos, 2)) < 0)
+				return -1;
+			vals[0] = map_2bit_far[b];
+		}
+		return 1;
+	}
+	return -1;
+}
+
+/*
+ * Entry: bits 0..23 - up to 6 values, 4 bits each, biased by 4
+ *        bits 24..27 - bits consumed
+ *        bits 28..31 - number of values
+ */
+static uint32_t make_entry(const struct filler *f, unsigned v)
+{
+	int pos = 0, tmp, n, i, count = 0;
+	int vals[2];
+	uint32_t e = 0;
+
+	while (1) {
+		tmp = pos;
+		n = symbol(f, v, &tmp, vals);
+		if (n < 0 || count + n > MAX_VALS)
+			break;
+		for (i = 0; i < n; i++)
+			e |= (uint32_t)(vals[i] + 4) << (4 * (count + i));
+		count += n;
+		pos = tmp;
+	}
+	return e | ((uint32_t)pos << 24) | ((uint32_t)count << 28);
+}
+
+int main(void)
+{
+	unsigned i, v;
+	const struct filler *f;
+
+	printf("/* Generated by gentables.c, do not edit. */\n\n");
+	printf("#define FILL_PEEK_BITS\t%d\n", PEEK_BITS);
+	printf("#define FILL_MAX_VALS\t%d\n\n", MAX_VALS);
+
+	for (i = 0; i < sizeof(filler_list) / sizeof(filler_list[0]); i++) {
+		f = &filler_list[i];
+		printf("static const uint32_t tab_%s[1 << FILL_PEEK_BITS] = {", f->name);
+		for (v = 0; v < (1 << PEEK_BITS); v++) {
+			if (v % 6 == 0)
+				printf("\n\t");
+			else
+				printf(" ");
+			printf("0x%08X,", (unsigned)make_entry(f, v));
+		}
+		printf("\n};\n\n");
+	}
+	return 0;
+}
@@ -0,0 +1,284 @@
+/*
+ * Seek index sidecar files for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * foo.acm gets its index in foo.acmidx, all values little-endian:
+ *
+ *   header  "ACMIDX" version:u16
+ *           file size:u64 mtime:u64
+ *           total_values:u32 rate:u32 level:u32 rows:u32
+ *           entries:u32 wrap_words:u32
+ *   entry   raw_ofs:u64 bit_data:u64 bit_avail:u32
+ *           wrapbuf:s32 * wrap_words
+ *
+ * Entry n is the start of block n.  wrapbuf is stored only for
+ * streams where acm_wrap_independent() is false, otherwise the
+ * index is restored one block early, see acm_seek_index_point().
+ * A stale index (size, mtime or header differ) is ignored.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+#define IDX_MAGIC	"ACMIDX"
+#define IDX_VERSION	1
+#define IDX_HEADER_LEN	48
+#define IDX_ENTRY_LEN	20
+
+struct idx_key {
+	uint64_t size, mtime;
+};
+
+static void put_le32(unsigned char *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static void put_le64(unsigned char *p, uint64_t v)
+{
+	put_le32(p, (uint32_t)v);
+	put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_le32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_le64(const unsigned char *p)
+{
+	return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+/* foo.acm -> foo.acmidx */
+char *acm_index_filename(const char *fn)
+{
+	const char *dot = strrchr(fn, '.');
+	size_t len = strlen(fn);
+	char *res;
+
+	if (dot != NULL && strchr(dot, '/') == NULL && strchr(dot, '\\') == NULL)
+		len = dot - fn;
+	res = (char *)malloc(len + sizeof(".acmidx"));
+	if (res) {
+		memcpy(res, fn, len);
+		strcpy(res + len, ".acmidx");
+	}
+	return res;
+}
+
+static int get_key(const char *fn, struct idx_key *key)
+{
+	struct stat st;
+
+	if (stat(fn, &st) != 0)
+		return ACM_ERR_OPEN;
+	key->size = st.st_size;
+	key->mtime = st.st_mtime;
+	return 0;
+}
+
+static void make_header(ACMStream *acm, const struct idx_key *key,
+			unsigned wrap_words, unsigned char *p)
+{
+	memcpy(p, IDX_MAGIC, 6);
+	p[6] = IDX_VERSION;
+	p[7] = IDX_VERSION >> 8;
+	put_le64(p + 8, key->size);
+	put_le64(p + 16, key->mtime);
+	put_le32(p + 24, acm->total_values);
+	put_le32(p + 28, acm->info.rate);
+	put_le32(p + 32, acm->info.acm_level);
+	put_le32(p + 36, acm->info.acm_rows);
+	put_le32(p + 40, acm->seek_idx_len);
+	put_le32(p + 44, wrap_words);
+}
+
+/*
+ * Build full seek index for stream opened from fn, and write it
+ * next to fn.  Returns 0 or error code.
+ */
+int acm_save_index(ACMStream *acm, const char *fn)
+{
+	unsigned char hdr[IDX_HEADER_LEN], *buf;
+	unsigned wrap_words, i, j, len;
+	struct idx_key key;
+	const ACMSeekPoint *sp;
+	const int *wrap;
+	char *idxfn;
+	FILE *f;
+	int err;
+
+	if ((err = get_key(fn, &key)) < 0)
+		return err;
+	if ((err = acm_build_seek_index(acm)) < 0)
+		return err;
+	if (acm->seek_idx_len == 0)
+		return ACM_ERR_OTHER;
+	if (acm->seek_wrap == NULL && !acm_wrap_independent(acm))
+		return ACM_ERR_OTHER;
+
+	wrap_words = acm_wrap_independent(acm) ? 0 : acm->wrapbuf_len;
+	len = IDX_ENTRY_LEN + wrap_words * 4;
+	buf = (unsigned char *)acm_mem_alloc(acm, len);
+	idxfn = acm_index_filename(fn);
+	if (!buf || !idxfn) {
+		err = ACM_ERR_OTHER;
+		goto out;
+	}
+	if ((f = fopen(idxfn, "wb")) == NULL) {
+		err = ACM_ERR_OPEN;
+		goto out;
+	}
+
+	make_header(acm, &key, wrap_words, hdr);
+	if (fwrite(hdr, 1, IDX_HEADER_LEN, f) != IDX_HEADER_LEN)
+		err = ACM_ERR_OTHER;
+	for (i = 0; i < acm->seek_idx_len && !err; i++) {
+		sp = &acm->seek_idx[i];
+		put_le64(buf, sp->raw_ofs);
+		put_le64(buf + 8, sp->bit_data);
+		put_le32(buf + 16, sp->bit_avail);
+		if (wrap_words > 0) {
+			wrap = acm->seek_wrap + (size_t)i * acm->wrapbuf_len;
+			for (j = 0; j < wrap_words; j++)
+				put_le32(buf + IDX_ENTRY_LEN + j * 4, wrap[j]);
+		}
+		if (fwrite(buf, 1, len, f) != len)
+			err = ACM_ERR_OTHER;
+	}
+	if (fclose(f) != 0 && !err)
+		err = ACM_ERR_OTHER;
+	/* half-written index would be ignored, but drop it anyway */
+	if (err)
+		remove(idxfn);
+out:
+	acm_mem_free(acm, buf);
+	free(idxfn);
+	return err;
+}
+
+/*
+ * Replace seek index with one saved by acm_save_index(),
+ * if that matches fn.  Returns 0 or error code.  Opening a
+ * file does not look for it, call this after acm_open_file()
+ * or acm_open_mmap() when seeks are expected.  An index
+ * without wrapbuf still grows as blocks are decoded, its new
+ * entries are also kept without wrapbuf.
+ */
+int acm_load_index(ACMStream *acm, const char *fn)
+{
+	unsigned char hdr[IDX_HEADER_LEN], want[IDX_HEADER_LEN], *buf = NULL;
+	unsigned count, wrap_words, nblocks, i, j, len;
+	struct idx_key key;
+	ACMSeekPoint *sp;
+	int *wrap;
+	char *idxfn;
+	FILE *f;
+	int err = 0;
+
+	if (acm->push_mode || acm->block_len == 0)
+		return ACM_ERR_NOT_SEEKABLE;
+	if ((err = get_key(fn, &key)) < 0)
+		return err;
+	if ((idxfn = acm_index_filename(fn)) == NULL)
+		return ACM_ERR_OTHER;
+	f = fopen(idxfn, "rb");
+	free(idxfn);
+	if (f == NULL)
+		return ACM_ERR_OPEN;
+
+	if (fread(hdr, 1, IDX_HEADER_LEN, f) != IDX_HEADER_LEN) {
+		err = ACM_ERR_BADFMT;
+		goto out;
+	}
+	count = get_le32(hdr + 40);
+	wrap_words = get_le32(hdr + 44);
+	nblocks = (acm->total_values + acm->block_len - 1) / acm->block_len;
+
+	/* everything but entries and wrap_words must match */
+	make_header(acm, &key, wrap_words, want);
+	put_le32(want + 40, count);
+	if (memcmp(hdr, want, IDX_HEADER_LEN) != 0 || count == 0
+	    || count > nblocks) {
+		err = ACM_ERR_BADFMT;
+		goto out;
+	}
+	if (wrap_words != (acm_wrap_independent(acm) ? 0 : acm->wrapbuf_len)) {
+		err = ACM_ERR_BADFMT;
+		goto out;
+	}
+	if (wrap_words > 0 && count > (size_t)-1 / sizeof(int) / wrap_words) {
+		err = ACM_ERR_BADFMT;
+		goto out;
+	}
+
+	acm_free_seek_index(acm);
+	acm->seek_idx = (ACMSeekPoint *)acm_mem_alloc(acm, count * sizeof(ACMSeekPoint));
+	if (wrap_words > 0)
+		acm->seek_wrap = (int *)acm_mem_alloc(acm, (size_t)count * wrap_words * sizeof(int));
+	len = IDX_ENTRY_LEN + wrap_words * 4;
+	buf = (unsigned char *)acm_mem_alloc(acm, len);
+	if (!acm->seek_idx || (wrap_words > 0 && !acm->seek_wrap) || !buf) {
+		err = ACM_ERR_OTHER;
+		goto bad;
+	}
+	acm->seek_idx_max = count;
+
+	for (i = 0; i < count; i++) {
+		if (fread(buf, 1, len, f) != len) {
+			err = ACM_ERR_BADFMT;
+			goto bad;
+		}
+		sp = &acm->seek_idx[i];
+		sp->raw_ofs = get_le64(buf);
+		sp->bit_data = get_le64(buf + 8);
+		sp->bit_avail = get_le32(buf + 16);
+		sp->stream_pos = i * acm->block_len;
+		if (sp->raw_ofs > key.size || sp->bit_avail > 63) {
+			err = ACM_ERR_BADFMT;
+			goto bad;
+		}
+		if (wrap_words > 0) {
+			wrap = acm->seek_wrap + (size_t)i * wrap_words;
+			for (j = 0; j < wrap_words; j++)
+				wrap[j] = (int)get_le32(buf + IDX_ENTRY_LEN + j * 4);
+		}
+	}
+	acm->seek_idx_len = count;
+	goto out;
+bad:
+	acm_free_seek_index(acm);
+out:
+	acm_mem_free(acm, buf);
+	fclose(f);
+	return err;
+}
@@ -19,11 +19,17 @@
 #ifndef __LIBACM_H
 #define __LIBACM_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define LIBACM_VERSION "1.3"
 
 #define ACM_ID		0x032897
 #define ACM_WORD	2
 
+/* zero bytes after read buffer data, for 8-byte loads */
+#define ACM_BUF_PAD	8
+
 #define ACM_OK			 0
 #define ACM_ERR_OTHER		-1
 #define ACM_ERR_OPEN		-2
@@ -33,6 +39,8 @@
 #define ACM_ERR_CORRUPT		-6
 #define ACM_ERR_UNEXPECTED_EOF	-7
 #define ACM_ERR_NOT_SEEKABLE	-8
+#define ACM_NEED_MORE_DATA	-9	/* push mode, see acm_feed() */
+#define ACM_ERR_NOT_SUPPORTED	-10	/* not compiled in */
 
 #if defined __GNUC__ && defined linux
 #	include <byteswap.h>
@@ -47,6 +55,46 @@
 #	error “Your compiler is not supported yet.”
 #endif
 
+/* output formats, index into ACMStream.out_func */
+#define ACM_OUT_S16LE	0
+#define ACM_OUT_U16LE	1
+#define ACM_OUT_S16BE	2
+#define ACM_OUT_U16BE	3
+
+/* kernel sets, see acm_simd_use() */
+#define ACM_SIMD_NONE	0	/* scalar code in decode.c */
+#define ACM_SIMD_SSE2	1
+#define ACM_SIMD_AVX2	2	/* planar output stays SSE2 */
+#define ACM_SIMD_NEON	3
+
+/* sample types for acm_read_frames(), in native byte order */
+#define ACM_SAMPLE_S16	0
+#define ACM_SAMPLE_U16	1
+#define ACM_SAMPLE_S32	2	/* top 16 bits same as S16 */
+#define ACM_SAMPLE_F32	3	/* [-1, 1) */
+#define ACM_SAMPLE_COUNT 4
+
+typedef struct ACMFormat {
+	unsigned sample;		/* ACM_SAMPLE_* */
+	int planar;			/* dst is array of channel pointers */
+	unsigned planes;		/* planar: 0 for channels, mono may ask 2 */
+} ACMFormat;
+
+typedef unsigned char *(*acm_out_func)(const int *src, unsigned char *dst,
+				       unsigned n, unsigned shift);
+typedef void (*acm_frames_func)(const int *src, void *dst,
+				unsigned n, unsigned shift);
+/* n frames of step words, to dst[0..nplanes-1] from frame pos */
+typedef void (*acm_planar_func)(const int *src, unsigned step, void **dst,
+				unsigned nplanes, unsigned pos, unsigned n,
+				unsigned shift);
+typedef void (*acm_juggle_func)(int *wrap_p, int *block_p,
+				unsigned sub_len, unsigned sub_count);
+/* juggle rows row0..row1 of block, one per acm_level */
+struct ACMStream;
+typedef void (*acm_block_func)(struct ACMStream *acm, unsigned row0,
+			       unsigned row1);
+
 typedef struct ACMInfo {
 	unsigned channels;
 	unsigned rate;
@@ -69,6 +117,75 @@ typedef struct {
 	int (*get_length_func)(void *datasrc);
 } acm_io_callbacks;
 
+/*
+ * Positional reads, see acm_open_decoder_v2().  Stream keeps its
+ * own position, so several streams may share one datasrc.  ofs is
+ * base of window plus a 32-bit offset inside it.
+ */
+typedef struct {
+	/* read up to len bytes at ofs, returns bytes, 0 at end or -1 */
+	int (*read_at)(void *datasrc, void *dst, unsigned len, uint64_t ofs);
+	/* optional, called on acm_close */
+	int (*close_func)(void *datasrc);
+	/* optional, returns size in bytes or -1 */
+	int64_t (*get_length_func)(void *datasrc);
+} acm_io_callbacks_v2;
+
+/* optional settings for acm_open_decoder_ex() and acm_open_memory_ex() */
+typedef struct ACMOptions {
+	/* allocator, default malloc/free; free_func may be NULL for arenas */
+	void *(*alloc_func)(size_t size, void *arg);
+	void (*free_func)(void *ptr, void *arg);
+	void *alloc_arg;
+
+	/*
+	 * Limits for untrusted input, 0 for none.  Streams over them
+	 * fail at open with ACM_ERR_BADFMT.  Decode time follows
+	 * values per byte, reads also check it per block and give
+	 * ACM_ERR_CORRUPT, eg. for push streams of unknown length.
+	 */
+	size_t max_block_mem;		/* bytes of block buffers */
+	unsigned max_values_per_byte;	/* decoded values per input byte */
+} ACMOptions;
+
+/* decoder statistics, see acm_get_stats() */
+struct acm_stats {
+	uint64_t bytes_read;		/* through read_func */
+	unsigned load_calls;		/* load_buf() calls */
+	unsigned blocks;		/* blocks decoded */
+	unsigned fillers[32];		/* columns for each filler index */
+	uint64_t fill_ns, juggle_ns, output_ns;
+	unsigned seek_forward, seek_rewind;
+	uint64_t seek_words;		/* words decoded and dropped by seeks */
+	unsigned seek_skipped;		/* blocks only parsed by seeks */
+};
+
+/* shared cache counters, see acm_cache_get_stats() */
+struct acm_cache_stats {
+	unsigned hits, misses;		/* acm_open_cached() calls */
+	unsigned evictions;
+	unsigned entries;
+	size_t bytes, budget;		/* decoded values kept, and limit */
+};
+
+/* result of acm_verify() */
+typedef struct ACMVerifyReport {
+	unsigned blocks;		/* blocks that parse */
+	unsigned pcm_header;		/* samples per channel, from header */
+	unsigned pcm_valid;		/* samples that decode, up to first bad block */
+	unsigned raw_end;		/* file offset where parsing stopped */
+	unsigned bad_blocks;		/* blocks that do not parse */
+	unsigned first_bad, last_bad;	/* their numbers, with bad_blocks > 0 */
+} ACMVerifyReport;
+
+/* decoder state at the start of a block, see acm_build_seek_index() */
+typedef struct ACMSeekPoint {
+	unsigned raw_ofs;		/* file offset of next unread byte */
+	uint64_t bit_data;
+	unsigned bit_avail;
+	unsigned stream_pos;		/* in words, first word of block */
+} ACMSeekPoint;
+
 struct ACMStream {
 	ACMInfo info;
 	unsigned total_values;
@@ -77,44 +194,152 @@ struct ACMStream {
 	void *io_arg;
 	acm_io_callbacks io;
 	unsigned data_len;
+	ACMOptions opts;
+	int force_chans;
 
 	/* acm stream buffer */
 	unsigned char *buf;
+	const unsigned char *data;	/* read window, into buf or memory */
 	unsigned buf_max, buf_size, buf_pos, bit_avail;
-	unsigned bit_data;
+	uint64_t bit_data;
 	unsigned buf_start_ofs;
 
+	/* window of v2 source, see acm_open_decoder_v2() */
+	void *win_arg;
+	acm_io_callbacks_v2 win_io;
+	uint64_t win_base;
+	unsigned win_len, win_pos;
+
+	/* memory backend, see acm_open_memory() */
+	const unsigned char *mem_data;
+	unsigned mem_len;
+	unsigned char mem_tail[2 * ACM_BUF_PAD];	/* last bytes, zero padded */
+
+	/* decoded values, see acm_open_pcm() */
+	const int *pcm_data;
+
 	/* block lengths (in samples) */
 	unsigned block_len;
 	unsigned wrapbuf_len;
 	/* buffers */
 	int *block;
 	int *wrapbuf;
-	int *ampbuf;
-	int *midbuf;			/* pointer into ampbuf */
+	int *tile;			/* column-major fill buffer */
+	unsigned block_max, wrapbuf_max, tile_max;	/* allocated sizes, in words */
+	/* current column in fill_block() */
+	int *fill_col;
+	unsigned fill_shift;
+	unsigned fill_skip;		/* only parse, see acm_skip_block() */
+	unsigned amp_step;		/* amplitude step of current block */
+	unsigned juggle_row;		/* rows of block juggled so far */
 	/* result */
 	unsigned block_ready:1;
 	unsigned file_eof:1;
 	unsigned wavc_file:1;
+	unsigned push_mode:1;
+	unsigned push_eof:1;		/* acm_feed() got end of input */
 	unsigned stream_pos;			/* in words. absolute */
 	unsigned block_pos;			/* in words, relative */
+	/* frame that block end splits, see split_frame() */
+	int split[2];
+	unsigned split_len;
+	/* push mode, bytes fed at last incomplete block and wanted next */
+	unsigned push_fail, push_hint;
+
+	/* seek index, one entry per decoded block */
+	ACMSeekPoint *seek_idx;
+	int *seek_wrap;			/* wrapbuf copy for each entry */
+	unsigned seek_idx_len, seek_idx_max;
+
+	/* format conversion and transform, may be replaced by simd.c */
+	acm_out_func out_func[4];
+	acm_frames_func frames_func[ACM_SAMPLE_COUNT];
+	acm_planar_func planar_func[ACM_SAMPLE_COUNT];
+	acm_planar_func planar2_func[ACM_SAMPLE_COUNT];	/* for 2 planes */
+	acm_juggle_func juggle;
+	acm_block_func juggle_block;
+
+	/*
+	 * Always here, so layout does not depend on config.h.  Only
+	 * counted with --enable-stats.
+	 */
+	struct acm_stats stats;
+	uint64_t stats_clock;		/* start of timed stage */
 };
 typedef struct ACMStream ACMStream;
 
 /* acmtool.c */
 void libacm_show_info(const char *fn,int cf_force_chans);
 void libacm_set_channels(const char *fn, int n_chan);
+void libacm_set_verbose(int verbose);
 void libacm_decode_file(const char *fn, const char *fn2, int cf_force_chans);
+void libacm_decode_batch(const char **inputs, unsigned ninputs,
+			 unsigned nthreads, int cf_force_chans);
 char * libacm_makefn(const char *fn, const char *ext);
+unsigned libacm_wav_size(const char *fn, int cf_force_chans);
+int libacm_decode_to_buf(const char *fn, void *dst, unsigned len, int cf_force_chans);
+void libacm_write_index(const char *fn);
+int libacm_verify_file(const char *fn, int cf_force_chans);
+
+/* cache.c */
+int acm_cache_set_budget(size_t bytes);
+void acm_cache_get_stats(struct acm_cache_stats *st);
+int acm_open_cached(ACMStream **res, const char *filename, int force_chans);
 
 /* decode.c */
+int acm_probe(const void *hdr, size_t len, ACMInfo *out, unsigned *total_values);
 int acm_open_decoder(ACMStream **res, void *io_arg, acm_io_callbacks io, int force_chans);
+int acm_open_decoder_ex(ACMStream **res, void *io_arg, acm_io_callbacks io,
+			int force_chans, const ACMOptions *opts);
+int acm_open_decoder_v2(ACMStream **res, void *io_arg, const acm_io_callbacks_v2 *io,
+			uint64_t base, uint64_t len, int force_chans,
+			const ACMOptions *opts);
+int acm_reset(ACMStream *acm, void *io_arg);
+int acm_open_memory(ACMStream **res, const void *data, size_t len, int force_chans);
+int acm_open_memory_ex(ACMStream **res, const void *data, size_t len,
+		       int force_chans, const ACMOptions *opts);
+int acm_open_push(ACMStream **res, int force_chans, const ACMOptions *opts);
+int acm_open_pcm(ACMStream **res, const int *values, unsigned total_values,
+		 const ACMInfo *info, unsigned raw_len,
+		 int (*release)(void *arg), void *arg);
+int acm_feed(ACMStream *acm, const void *data, unsigned len);
 int acm_read(ACMStream *acm, void *buf, unsigned nbytes,
 		int bigendianp, int wordlen, int sgned);
+int acm_read_block_ptr(ACMStream *acm, const int **data, unsigned maxwords);
+int acm_read_float(ACMStream *acm, float *dst, unsigned maxwords);
+int acm_read_frames(ACMStream *acm, void *dst, unsigned nframes, const ACMFormat *fmt);
+int acm_verify(ACMStream *acm, ACMVerifyReport *rep);
 void acm_close(ACMStream *acm);
 
+/* idxfile.c */
+char *acm_index_filename(const char *fn);
+int acm_save_index(ACMStream *acm, const char *fn);
+int acm_load_index(ACMStream *acm, const char *fn);
+
+/* parallel.c */
+int acm_decode_all_parallel(ACMStream *acm, void *dst, unsigned nthreads);
+
+/* ring.c */
+typedef struct acm_ring acm_ring;
+acm_ring *acm_ring_new(ACMStream *acm, unsigned depth, int bigendianp);
+void acm_ring_free(acm_ring *r);
+int acm_ring_peek(acm_ring *r, const void **data);
+void acm_ring_consume(acm_ring *r, unsigned bytes);
+int acm_ring_read(acm_ring *r, void *dst, unsigned bytes);
+int acm_ring_seek(acm_ring *r, unsigned pcm_pos);
+unsigned acm_ring_tell(acm_ring *r);
+
+/* simd.c */
+int acm_simd_use(ACMStream *acm, unsigned set);
+
 /* util.c */
 int acm_open_file(ACMStream **acm, const char *filename, int force_chans);
+int acm_open_mmap(ACMStream **acm, const char *filename, int force_chans);
+int acm_open_fd(ACMStream **acm, int fd, uint64_t base, uint64_t len, int force_chans);
+int acm_probe_file(const char *filename, ACMInfo *out, unsigned *total_values,
+		   unsigned *raw_len);
+unsigned acm_probe_time(const ACMInfo *inf, unsigned total_values);
+unsigned acm_probe_bitrate(const ACMInfo *inf, unsigned total_values, unsigned raw_len);
 const ACMInfo *acm_info(ACMStream *acm);
 int acm_seekable(ACMStream *acm);
 unsigned acm_bitrate(ACMStream *acm);
@@ -126,10 +351,14 @@ unsigned acm_pcm_total(ACMStream *acm);
 unsigned acm_pcm_tell(ACMStream *acm);
 unsigned acm_time_total(ACMStream *acm);
 unsigned acm_time_tell(ACMStream *acm);
+size_t acm_mem_usage(ACMStream *acm);
+int acm_get_stats(ACMStream *acm, struct acm_stats *st);
 int acm_read_loop(ACMStream *acm, void *dst, unsigned len,
 		int bigendianp, int wordlen, int sgned);
 int acm_seek_pcm(ACMStream *acm, unsigned pcm_pos);
 int acm_seek_time(ACMStream *acm, unsigned pos_ms);
+int acm_enable_seek_index(ACMStream *acm);
+int acm_build_seek_index(ACMStream *acm);
 const char *acm_strerror(int err);
 
 #endif
@@ -0,0 +1,283 @@
+/*
+ * Parallel decoding for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Blocks depend on each other only through wrapbuf.  If a block has
+ * at least 2 rows, wrapbuf after it does not depend on wrapbuf before
+ * it: each juggle() pass keeps the last input rows of a column, while
+ * old wrapbuf reaches only the first rows.  So a worker can start one
+ * block early with zeroed wrapbuf, and is exact from the next block.
+ * Block start positions come from a quick pass that only parses bits.
+ *
+ * For single-row blocks the full seek index is built instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+struct worker {
+	ACMStream *acm;			/* private stream, single channel */
+	const ACMSeekPoint *start;	/* NULL means start of file */
+	const int *wrap;		/* wrapbuf at start, NULL for zeroes */
+	unsigned first, end;		/* words to output */
+	unsigned char *dst;		/* output for word 0 */
+	int err;
+};
+
+static void run_worker(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	ACMStream *acm = w->acm;
+	int res;
+
+	if (w->start != NULL)
+		res = acm_restore_seek_point(acm, w->start, w->wrap);
+	else
+		res = acm_rewind(acm);
+	if (res < 0) {
+		w->err = res;
+		return;
+	}
+
+	/* bring wrapbuf up to date */
+	while (acm->stream_pos < w->first) {
+		res = acm_read(acm, NULL, (w->first - acm->stream_pos) * ACM_WORD, 0,2,1);
+		if (res <= 0)
+			goto stop;
+	}
+
+	while (acm->stream_pos < w->end) {
+		res = acm_read(acm, w->dst + acm->stream_pos * ACM_WORD,
+				(w->end - acm->stream_pos) * ACM_WORD, 0,2,1);
+		if (res <= 0)
+			goto stop;
+	}
+	return;
+stop:
+	w->err = res < 0 ? res : ACM_ERR_UNEXPECTED_EOF;
+}
+
+/* read whole file into memory, for streams not opened from memory */
+static int load_file(ACMStream *acm, unsigned char **res, unsigned *len)
+{
+	unsigned char *data;
+	unsigned got = 0;
+	int n, err = 0;
+
+	if (acm->io.seek_func == NULL || acm->data_len == 0)
+		return ACM_ERR_NOT_SEEKABLE;
+	data = (unsigned char *)acm_mem_alloc(acm, acm->data_len);
+	if (!data)
+		return ACM_ERR_OTHER;
+
+	if (acm->io.seek_func(acm->io_arg, 0, SEEK_SET) < 0)
+		err = ACM_ERR_NOT_SEEKABLE;
+	while (!err && got < acm->data_len) {
+		n = acm->io.read_func(data + got, 1, acm->data_len - got, acm->io_arg);
+		if (n < 0)
+			err = ACM_ERR_READ_ERR;
+		else if (n == 0)
+			break;
+		else
+			got += n;
+	}
+
+	/* put file position back where stream expects it */
+	if (!acm->file_eof && acm->io.seek_func(acm->io_arg,
+			acm->buf_start_ofs + acm->buf_size, SEEK_SET) < 0 && !err)
+		err = ACM_ERR_NOT_SEEKABLE;
+
+	if (err) {
+		acm_mem_free(acm, data);
+		return err;
+	}
+	*res = data;
+	*len = got;
+	return 0;
+}
+
+/* find start of each block, returns block count */
+static int scan_blocks(ACMStream *acm, ACMSeekPoint *pts, unsigned max)
+{
+	unsigned n = 0;
+	int res;
+
+	if ((res = acm_rewind(acm)) < 0)
+		return res;
+	while (n < max) {
+		acm_save_seek_point(acm, &pts[n]);
+		res = acm_skip_block(acm);
+		if (res <= 0)
+			break;
+		n++;
+	}
+	/* like acm_read_loop(), error only if nothing can be decoded */
+	if (n == 0 && res < 0)
+		return res;
+	return n;
+}
+
+/*
+ * Decode whole stream into dst as signed 16-bit little-endian,
+ * dst must have room for acm_pcm_total() * channels words.
+ * Stream position is not changed.  Returns bytes written, same
+ * output as acm_read_loop().  Streams over INT_MAX bytes of output
+ * give ACM_ERR_OTHER.  Private streams get options of acm.
+ */
+int acm_decode_all_parallel(ACMStream *acm, void *dst, unsigned nthreads)
+{
+	const unsigned char *data = acm->mem_data;
+	unsigned char *copy = NULL;
+	unsigned len = acm->mem_len;
+	unsigned total, nblocks, i, b, done;
+	uint64_t end;
+	ACMSeekPoint *pts = NULL;
+	ACMStream *scan;
+	struct worker *w;
+	acm_thread **tid;
+	int res = 0;
+
+	total = acm->total_values - acm->total_values % acm->info.channels;
+	nblocks = (total + acm->block_len - 1) / acm->block_len;
+	if (nblocks == 0)
+		return 0;
+	if ((uint64_t)total * ACM_WORD > INT_MAX)
+		return ACM_ERR_OTHER;
+
+	/* pcm view, see acm_open_pcm() */
+	if (acm->pcm_data != NULL) {
+		acm->out_func[ACM_OUT_S16LE](acm->pcm_data, (unsigned char *)dst,
+					    total, acm->info.acm_level);
+		return total * ACM_WORD;
+	}
+	if (nthreads < 1)
+		nthreads = 1;
+	if (nthreads > nblocks)
+		nthreads = nblocks;
+
+	if (!acm_wrap_independent(acm) && nthreads > 1) {
+		if ((res = acm_build_seek_index(acm)) < 0)
+			return res;
+	}
+
+	if (data == NULL) {
+		if ((res = load_file(acm, &copy, &len)) < 0)
+			return res;
+		data = copy;
+	}
+
+	w = (struct worker *)acm_mem_alloc(acm, nthreads * sizeof(*w));
+	if (w)
+		memset(w, 0, nthreads * sizeof(*w));
+	tid = (acm_thread **)acm_mem_alloc(acm, nthreads * sizeof(*tid));
+	if (!w || !tid) {
+		res = ACM_ERR_OTHER;
+		goto out;
+	}
+
+	/* block starts are needed only if the index does not cover them */
+	b = (uint64_t)nblocks * (nthreads - 1) / nthreads;
+	if (nthreads > 1 && b >= acm->seek_idx_len && acm_wrap_independent(acm)) {
+		pts = (ACMSeekPoint *)acm_mem_alloc(acm, (size_t)nblocks * sizeof(*pts));
+		if (!pts) {
+			res = ACM_ERR_OTHER;
+			goto out;
+		}
+		if ((res = acm_open_memory_ex(&scan, data, len, 1, &acm->opts)) < 0)
+			goto out;
+		res = scan_blocks(scan, pts, nblocks);
+		acm_close(scan);
+		if (res < 0)
+			goto out;
+		nblocks = res;
+		if (total > (uint64_t)nblocks * acm->block_len)
+			total = nblocks * acm->block_len;
+		if (nthreads > nblocks)
+			nthreads = nblocks;
+		res = 0;
+	}
+
+	for (i = 0; i < nthreads; i++) {
+		b = (uint64_t)nblocks * i / nthreads;
+		w[i].first = b * acm->block_len;
+		end = (uint64_t)nblocks * (i + 1) / nthreads * acm->block_len;
+		w[i].end = end < total ? end : total;
+		if (i == nthreads - 1)
+			w[i].end = total;
+		w[i].dst = (unsigned char *)dst;
+
+		if (b == 0) {
+			/* from start of file */
+		} else if (b < acm->seek_idx_len) {
+			w[i].start = acm_seek_index_point(acm, b, &w[i].wrap);
+		} else if (pts != NULL) {
+			w[i].start = &pts[b - 1];
+		} else if (acm->seek_idx_len > 0) {
+			w[i].start = acm_seek_index_point(acm, b, &w[i].wrap);
+		}
+
+		if ((res = acm_open_memory_ex(&w[i].acm, data, len, 1, &acm->opts)) < 0)
+			goto out;
+	}
+
+	/* first range in this thread, or all if threads fail */
+	for (i = 1; i < nthreads; i++) {
+		if ((tid[i] = acm_thread_start(run_worker, &w[i])) == NULL)
+			break;
+	}
+	done = i;
+	run_worker(&w[0]);
+	for (i = done; i < nthreads; i++)
+		run_worker(&w[i]);
+	for (i = 1; i < done; i++)
+		acm_thread_join(tid[i]);
+
+	/* output is valid up to first range that stopped short */
+	res = 0;
+	for (i = 0; i < nthreads; i++) {
+		if (w[i].err < 0) {
+			res = w[i].acm->stream_pos > w[i].first
+				? w[i].acm->stream_pos * ACM_WORD
+				: w[i].first * ACM_WORD;
+			if (res == 0)
+				res = w[i].err;
+			break;
+		}
+		res = w[i].end * ACM_WORD;
+	}
+
+out:
+	if (w) {
+		for (i = 0; i < nthreads; i++)
+			acm_close(w[i].acm);
+		acm_mem_free(acm, w);
+	}
+	acm_mem_free(acm, tid);
+	acm_mem_free(acm, pts);
+	acm_mem_free(acm, copy);
+	return res;
+}
@@ -0,0 +1,372 @@
+/*
+ * Decode-ahead ring for libacm players.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * A producer thread decodes whole blocks into a ring of slots,
+ * the player takes data from it.  head is written only by the
+ * producer and tail only by the consumer, so passing a slot needs
+ * no lock.  The mutex is taken only to sleep on an empty or full
+ * ring, and to wake a side that sleeps.
+ *
+ * Seek is asked by the consumer: it drops all full slots, stores
+ * the target and bumps epoch.  The producer seeks when it sees new
+ * epoch and tags slots with it, consumer skips slots of older ones.
+ * The consumer waits only for the seek itself, to get its result.
+ *
+ * Consumer position is published like head and tail, so
+ * acm_ring_tell() works from any thread.
+ *
+ * If thread cannot be started, consumer decodes slots itself.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+#define RING_DEPTH	4		/* default slot count */
+#define RING_MIN_WORDS	4096		/* slot size, rounded up to blocks */
+
+#ifdef _MSC_VER
+#define ring_load(p)		((unsigned)InterlockedCompareExchange((volatile LONG *)(p), 0, 0))
+#define ring_store(p, v)	InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#define ring_fence()		MemoryBarrier()
+#else
+#define ring_load(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ring_store(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ring_fence()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+struct ring_slot {
+	unsigned char *data;
+	unsigned len;			/* bytes, 0 at end of stream */
+	int err;			/* with len == 0 */
+	unsigned pos;			/* in words, of first byte */
+	unsigned epoch;
+};
+
+struct acm_ring {
+	ACMStream *acm;
+	int bigendianp, native;		/* native: bigendianp is host order */
+	unsigned depth, slot_bytes;
+	struct ring_slot *slots;
+	unsigned char *mem;
+
+	/* written by producer */
+	unsigned head;
+	unsigned prod_epoch;
+	int at_end;
+	int seek_err;			/* for next slot */
+	unsigned seek_done;		/* epoch of last seek */
+	int seek_res;			/* its result */
+
+	/* written by consumer */
+	unsigned tail, read_ofs;
+	unsigned epoch, seek_pos;
+	unsigned pos;			/* in words, of next byte, any thread reads */
+	unsigned quit;
+
+	/* sleeping only */
+	acm_mutex *lock;
+	acm_cond *cond;
+	unsigned prod_waiting, cons_waiting;
+	acm_thread *thread;
+};
+
+static void wake(acm_ring *r, unsigned *waiting)
+{
+	/* pairs with fence in waiter, one of us sees the other */
+	ring_fence();
+	if (ring_load(waiting)) {
+		acm_mutex_lock(r->lock);
+		acm_cond_broadcast(r->cond);
+		acm_mutex_unlock(r->lock);
+	}
+}
+
+/* fill slot in one call, returns bytes */
+static int read_native(acm_ring *r, unsigned char *dst)
+{
+	static const ACMFormat fmt = { ACM_SAMPLE_S16, 0, 0 };
+	unsigned frame = r->acm->info.channels * ACM_WORD;
+	int res;
+
+	res = acm_read_frames(r->acm, dst, r->slot_bytes / frame, &fmt);
+	return res > 0 ? res * (int)frame : res;
+}
+
+/* seek for epoch e, error goes also to next slot */
+static int do_seek(acm_ring *r, unsigned e)
+{
+	int res;
+
+	r->prod_epoch = e;
+	r->at_end = 0;
+	res = acm_seek_pcm(r->acm, ring_load(&r->seek_pos));
+	r->seek_err = res < 0 ? res : 0;
+	ring_store(&r->seek_res, res);
+	ring_store(&r->seek_done, e);
+	return res;
+}
+
+/* decode into next free slot, returns 0 if there was nothing to do */
+static int produce(acm_ring *r)
+{
+	unsigned e = ring_load(&r->epoch);
+	struct ring_slot *s;
+	int res;
+
+	if (e != r->prod_epoch) {
+		do_seek(r, e);
+		wake(r, &r->cons_waiting);
+	}
+	if (r->at_end || r->head - ring_load(&r->tail) == r->depth)
+		return 0;
+
+	s = &r->slots[r->head % r->depth];
+	s->epoch = e;
+	s->pos = r->acm->stream_pos;
+	if (r->seek_err) {
+		res = r->seek_err;
+		r->seek_err = 0;
+	} else if (r->native)
+		res = read_native(r, s->data);
+	else
+		res = acm_read_loop(r->acm, s->data, r->slot_bytes,
+				    r->bigendianp, ACM_WORD, 1);
+	if (res > 0) {
+		s->len = res;
+		s->err = 0;
+	} else {
+		s->len = 0;
+		s->err = res;
+		r->at_end = 1;
+	}
+
+	ring_store(&r->head, r->head + 1);
+	wake(r, &r->cons_waiting);
+	return 1;
+}
+
+static void producer_wait(acm_ring *r)
+{
+	acm_mutex_lock(r->lock);
+	ring_store(&r->prod_waiting, 1);
+	ring_fence();
+	if (!ring_load(&r->quit) && ring_load(&r->epoch) == r->prod_epoch
+	    && (r->at_end || r->head - ring_load(&r->tail) == r->depth))
+		acm_cond_wait(r->cond, r->lock);
+	ring_store(&r->prod_waiting, 0);
+	acm_mutex_unlock(r->lock);
+}
+
+static void producer_main(void *arg)
+{
+	acm_ring *r = (acm_ring *)arg;
+
+	while (!ring_load(&r->quit)) {
+		if (!produce(r))
+			producer_wait(r);
+	}
+}
+
+static void consumer_wait(acm_ring *r)
+{
+	acm_mutex_lock(r->lock);
+	ring_store(&r->cons_waiting, 1);
+	ring_fence();
+	if (r->tail == ring_load(&r->head))
+		acm_cond_wait(r->cond, r->lock);
+	ring_store(&r->cons_waiting, 0);
+	acm_mutex_unlock(r->lock);
+}
+
+static void next_slot(acm_ring *r)
+{
+	r->read_ofs = 0;
+	ring_store(&r->tail, r->tail + 1);
+	wake(r, &r->prod_waiting);
+}
+
+/*
+ * Start decoding ahead from current position of acm, output is
+ * 16-bit signed.  depth is slot count, 0 for default.  Stream
+ * must not be used directly until acm_ring_free().
+ */
+acm_ring *acm_ring_new(ACMStream *acm, unsigned depth, int bigendianp)
+{
+	static const uint16_t one = 1;
+	acm_ring *r;
+	unsigned i, words;
+
+	r = (acm_ring *)calloc(1, sizeof(*r));
+	if (!r)
+		return NULL;
+	r->acm = acm;
+	r->bigendianp = bigendianp;
+	r->native = (*(const unsigned char *)&one == 0) == (bigendianp != 0);
+	r->depth = depth > 0 ? depth : RING_DEPTH;
+	r->pos = acm->stream_pos;
+
+	words = (RING_MIN_WORDS + acm->block_len - 1) / acm->block_len * acm->block_len;
+	r->slot_bytes = words * ACM_WORD;
+	r->slots = (struct ring_slot *)calloc(r->depth, sizeof(*r->slots));
+	r->mem = (unsigned char *)malloc((size_t)r->depth * r->slot_bytes);
+	r->lock = acm_mutex_new();
+	r->cond = acm_cond_new();
+	if (!r->slots || !r->mem || !r->lock || !r->cond) {
+		acm_ring_free(r);
+		return NULL;
+	}
+	for (i = 0; i < r->depth; i++)
+		r->slots[i].data = r->mem + (size_t)i * r->slot_bytes;
+
+	/* without thread, acm_ring_peek() decodes */
+	r->thread = acm_thread_start(producer_main, r);
+	return r;
+}
+
+/* Stop producer.  Stream position is undefined after that. */
+void acm_ring_free(acm_ring *r)
+{
+	if (r->thread) {
+		ring_store(&r->quit, 1);
+		acm_mutex_lock(r->lock);
+		acm_cond_broadcast(r->cond);
+		acm_mutex_unlock(r->lock);
+		acm_thread_join(r->thread);
+	}
+	if (r->cond)
+		acm_cond_free(r->cond);
+	if (r->lock)
+		acm_mutex_free(r->lock);
+	free(r->mem);
+	free(r->slots);
+	free(r);
+}
+
+/*
+ * Wait for decoded data, *data points to it until acm_ring_consume().
+ * Returns byte count, 0 at end of stream or error code.
+ */
+int acm_ring_peek(acm_ring *r, const void **data)
+{
+	struct ring_slot *s;
+
+	while (1) {
+		if (r->tail == ring_load(&r->head)) {
+			if (r->thread)
+				consumer_wait(r);
+			else
+				produce(r);
+			continue;
+		}
+		s = &r->slots[r->tail % r->depth];
+		if (s->epoch != r->epoch) {
+			next_slot(r);
+			continue;
+		}
+		if (s->len == 0)
+			return s->err;
+		ring_store(&r->pos, s->pos + r->read_ofs / ACM_WORD);
+		*data = s->data + r->read_ofs;
+		return s->len - r->read_ofs;
+	}
+}
+
+/* drop bytes from data given by acm_ring_peek() */
+void acm_ring_consume(acm_ring *r, unsigned bytes)
+{
+	struct ring_slot *s = &r->slots[r->tail % r->depth];
+
+	r->read_ofs += bytes;
+	ring_store(&r->pos, r->pos + bytes / ACM_WORD);
+	if (r->read_ofs >= s->len)
+		next_slot(r);
+}
+
+/* like acm_read_loop() */
+int acm_ring_read(acm_ring *r, void *dst, unsigned bytes)
+{
+	unsigned char *dstp = (unsigned char *)dst;
+	const void *src;
+	int got = 0, res;
+
+	while (bytes > 0) {
+		res = acm_ring_peek(r, &src);
+		if (res <= 0)
+			return got > 0 ? got : res;
+		if ((unsigned)res > bytes)
+			res = bytes;
+		memcpy(dstp, src, res);
+		acm_ring_consume(r, res);
+		dstp += res;
+		got += res;
+		bytes -= res;
+	}
+	return got;
+}
+
+/*
+ * Seek to pcm_pos, like acm_seek_pcm().  Waits until producer has
+ * done the seek, but not for data after it.  Returns new position
+ * or error code, errors are also returned by next acm_ring_peek().
+ */
+int acm_ring_seek(acm_ring *r, unsigned pcm_pos)
+{
+	unsigned e = r->epoch + 1;
+	int res;
+
+	/* drop all full slots, later ones are skipped by epoch */
+	ring_store(&r->tail, ring_load(&r->head));
+	r->read_ofs = 0;
+	ring_store(&r->seek_pos, pcm_pos);
+	ring_store(&r->epoch, e);
+
+	if (r->thread == NULL) {
+		res = do_seek(r, e);
+	} else {
+		wake(r, &r->prod_waiting);
+		acm_mutex_lock(r->lock);
+		ring_store(&r->cons_waiting, 1);
+		ring_fence();
+		while (ring_load(&r->seek_done) != e)
+			acm_cond_wait(r->cond, r->lock);
+		ring_store(&r->cons_waiting, 0);
+		acm_mutex_unlock(r->lock);
+		res = ring_load(&r->seek_res);
+	}
+
+	ring_store(&r->pos, (res >= 0 ? (unsigned)res : pcm_pos) * r->acm->info.channels);
+	return res;
+}
+
+/* position of next sample given to consumer, from any thread */
+unsigned acm_ring_tell(acm_ring *r)
+{
+	return ring_load(&r->pos) / r->acm->info.channels;
+}
@@ -0,0 +1,523 @@
+/*
+ * SIMD kernels for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Scalar code in decode.c is the reference, kernels here must give
+ * bit-exact results.  acm_simd_init() replaces function pointers in
+ * ACMStream with best versions supported by the running CPU,
+ * acm_simd_use() with a given set, eg. for tests.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_X86 1
+#include <immintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) \
+	&& defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * Tail handling, same as scalar code.
+ */
+#define OUT_TAIL(swap, bias) do { \
+		while (n--) { \
+			int val = (*src++ >> shift) + (bias ? 0x8000 : 0); \
+			if (swap) { \
+				*dst++ = (val >> 8) & 0xFF; \
+				*dst++ = val & 0xFF; \
+			} else { \
+				*dst++ = val & 0xFF; \
+				*dst++ = (val >> 8) & 0xFF; \
+			} \
+		} \
+	} while (0)
+
+/*
+ * Remaining frames of 2-plane output, same as scalar code.
+ * step 1 is mono, duplicated.
+ */
+#define PLANAR2_TAIL(conv) do { \
+		for (; i < n; i++, src += step) { \
+			l[i] = conv(src[0]); \
+			r[i] = conv(src[step - 1]); \
+		} \
+	} while (0)
+#define TAIL_S16(v)	((int16_t)((v) >> shift))
+#define TAIL_F32(v)	((v) * scale)
+
+/*
+ * Remaining columns of juggle(), same as scalar code.
+ */
+#define JUGGLE_TAIL() do { \
+		for (; i < sub_len; i++) { \
+			int *q = block_p + i, s0, s1, s2, s3; \
+			s0 = wrap_p[2*i]; \
+			s1 = wrap_p[2*i + 1]; \
+			for (j = 0; j < sub_count/2; j++) { \
+				s2 = *q;  *q = s1*2 + (s0 + s2);  q += sub_len; \
+				s3 = *q;  *q = s2*2 - (s1 + s3);  q += sub_len; \
+				s0 = s2;  s1 = s3; \
+			} \
+			wrap_p[2*i] = s0; \
+			wrap_p[2*i + 1] = s1; \
+		} \
+	} while (0)
+
+#ifdef USE_X86
+
+/*
+ * SSE2 - 8 samples per loop.  packs saturates, so sign-extend
+ * low 16 bits first to get truncation as in scalar code.
+ */
+#define SSE2_OUT(name, swap, bias) \
+__attribute__((target("sse2"))) \
+static unsigned char *name(const int *src, unsigned char *dst, \
+			   unsigned n, unsigned shift) \
+{ \
+	__m128i sh = _mm_cvtsi32_si128(shift); \
+	__m128i a, b, v; \
+	while (n >= 8) { \
+		a = _mm_loadu_si128((const __m128i *)src); \
+		b = _mm_loadu_si128((const __m128i *)(src + 4)); \
+		a = _mm_sra_epi32(a, sh); \
+		b = _mm_sra_epi32(b, sh); \
+		a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16); \
+		b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16); \
+		v = _mm_packs_epi32(a, b); \
+		if (bias) \
+			v = _mm_xor_si128(v, _mm_set1_epi16((short)0x8000)); \
+		if (swap) \
+			v = _mm_or_si128(_mm_slli_epi16(v, 8), \
+					 _mm_srli_epi16(v, 8)); \
+		_mm_storeu_si128((__m128i *)dst, v); \
+		src += 8; \
+		dst += 16; \
+		n -= 8; \
+	} \
+	OUT_TAIL(swap, bias); \
+	return dst; \
+}
+
+SSE2_OUT(out_s16le_sse2, 0, 0)
+SSE2_OUT(out_u16le_sse2, 0, 1)
+SSE2_OUT(out_s16be_sse2, 1, 0)
+SSE2_OUT(out_u16be_sse2, 1, 1)
+
+/*
+ * AVX2 - 16 samples per loop.  packs works inside 128-bit lanes,
+ * permute puts the quadwords back in order.
+ */
+#define AVX2_OUT(name, swap, bias) \
+__attribute__((target("avx2"))) \
+static unsigned char *name(const int *src, unsigned char *dst, \
+			   unsigned n, unsigned shift) \
+{ \
+	__m128i sh = _mm_cvtsi32_si128(shift); \
+	__m256i a, b, v; \
+	while (n >= 16) { \
+		a = _mm256_loadu_si256((const __m256i *)src); \
+		b = _mm256_loadu_si256((const __m256i *)(src + 8)); \
+		a = _mm256_sra_epi32(a, sh); \
+		b = _mm256_sra_epi32(b, sh); \
+		a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16); \
+		b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16); \
+		v = _mm256_packs_epi32(a, b); \
+		v = _mm256_permute4x64_epi64(v, 0xD8); \
+		if (bias) \
+			v = _mm256_xor_si256(v, _mm256_set1_epi16((short)0x8000)); \
+		if (swap) \
+			v = _mm256_or_si256(_mm256_slli_epi16(v, 8), \
+					    _mm256_srli_epi16(v, 8)); \
+		_mm256_storeu_si256((__m256i *)dst, v); \
+		src += 16; \
+		dst += 32; \
+		n -= 16; \
+	} \
+	OUT_TAIL(swap, bias); \
+	return dst; \
+}
+
+AVX2_OUT(out_s16le_avx2, 0, 0)
+AVX2_OUT(out_u16le_avx2, 0, 1)
+AVX2_OUT(out_s16be_avx2, 1, 0)
+AVX2_OUT(out_u16be_avx2, 1, 1)
+
+/*
+ * 2-plane output, 8 frames per loop for s16 and 4 for float.
+ * Stereo pairs are split with shuffles.
+ */
+#define SSE2_S16(x) _mm_srai_epi32(_mm_slli_epi32(_mm_sra_epi32(x, sh), 16), 16)
+#define SSE2_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+
+__attribute__((target("sse2")))
+static void planar2_s16_sse2(const int *src, unsigned step, void **dst,
+			     unsigned nplanes, unsigned pos, unsigned n,
+			     unsigned shift)
+{
+	int16_t *l = (int16_t *)dst[0] + pos, *r = (int16_t *)dst[1] + pos;
+	__m128i sh = _mm_cvtsi32_si128(shift);
+	__m128i a, b, c, d, v;
+	unsigned i = 0;
+
+	(void)nplanes;
+	if (step == 1) {
+		for (; i + 8 <= n; i += 8, src += 8) {
+			v = _mm_packs_epi32(SSE2_S16(SSE2_LOAD(src)),
+					    SSE2_S16(SSE2_LOAD(src + 4)));
+			_mm_storeu_si128((__m128i *)(l + i), v);
+			_mm_storeu_si128((__m128i *)(r + i), v);
+		}
+	} else {
+		for (; i + 8 <= n; i += 8, src += 16) {
+			/* L0 R0 L1 R1 -> L0 L1 R0 R1 */
+			a = _mm_shuffle_epi32(SSE2_S16(SSE2_LOAD(src)), _MM_SHUFFLE(3, 1, 2, 0));
+			b = _mm_shuffle_epi32(SSE2_S16(SSE2_LOAD(src + 4)), _MM_SHUFFLE(3, 1, 2, 0));
+			c = _mm_shuffle_epi32(SSE2_S16(SSE2_LOAD(src + 8)), _MM_SHUFFLE(3, 1, 2, 0));
+			d = _mm_shuffle_epi32(SSE2_S16(SSE2_LOAD(src + 12)), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_si128((__m128i *)(l + i), _mm_packs_epi32(
+				_mm_unpacklo_epi64(a, b), _mm_unpacklo_epi64(c, d)));
+			_mm_storeu_si128((__m128i *)(r + i), _mm_packs_epi32(
+				_mm_unpackhi_epi64(a, b), _mm_unpackhi_epi64(c, d)));
+		}
+	}
+	PLANAR2_TAIL(TAIL_S16);
+}
+
+__attribute__((target("sse2")))
+static void planar2_f32_sse2(const int *src, unsigned step, void **dst,
+			     unsigned nplanes, unsigned pos, unsigned n,
+			     unsigned shift)
+{
+	float *l = (float *)dst[0] + pos, *r = (float *)dst[1] + pos;
+	float scale = 1.0f / (float)(32768u << shift);
+	__m128 sc = _mm_set1_ps(scale), a, b;
+	unsigned i = 0;
+
+	(void)nplanes;
+	if (step == 1) {
+		for (; i + 4 <= n; i += 4, src += 4) {
+			a = _mm_mul_ps(_mm_cvtepi32_ps(SSE2_LOAD(src)), sc);
+			_mm_storeu_ps(l + i, a);
+			_mm_storeu_ps(r + i, a);
+		}
+	} else {
+		for (; i + 4 <= n; i += 4, src += 8) {
+			a = _mm_mul_ps(_mm_cvtepi32_ps(SSE2_LOAD(src)), sc);
+			b = _mm_mul_ps(_mm_cvtepi32_ps(SSE2_LOAD(src + 4)), sc);
+			_mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+	}
+	PLANAR2_TAIL(TAIL_F32);
+}
+
+/*
+ * juggle() across columns.  Columns are independent, so each lane
+ * works on one column and rows are plain vector loads.  wrapbuf
+ * keeps (r0, r1) pairs per column, they are split into two vectors.
+ */
+/* 4 columns from i, rows are sub_len apart */
+__attribute__((target("sse2")))
+static inline void juggle4_sse2(int *wrap_p, int *block_p, unsigned i,
+				unsigned sub_len, unsigned sub_count)
+{
+	unsigned j;
+	__m128i r0, r1, r2, r3, w0, w1;
+	int *p;
+
+	w0 = _mm_loadu_si128((const __m128i *)(wrap_p + 2*i));
+	w1 = _mm_loadu_si128((const __m128i *)(wrap_p + 2*i + 4));
+	r0 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(w0),
+			_mm_castsi128_ps(w1), _MM_SHUFFLE(2, 0, 2, 0)));
+	r1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(w0),
+			_mm_castsi128_ps(w1), _MM_SHUFFLE(3, 1, 3, 1)));
+	p = block_p + i;
+	for (j = 0; j < sub_count/2; j++) {
+		r2 = _mm_loadu_si128((const __m128i *)p);
+		_mm_storeu_si128((__m128i *)p, _mm_add_epi32(
+			_mm_add_epi32(r1, r1), _mm_add_epi32(r0, r2)));
+		p += sub_len;
+		r3 = _mm_loadu_si128((const __m128i *)p);
+		_mm_storeu_si128((__m128i *)p, _mm_sub_epi32(
+			_mm_add_epi32(r2, r2), _mm_add_epi32(r1, r3)));
+		p += sub_len;
+		r0 = r2;
+		r1 = r3;
+	}
+	_mm_storeu_si128((__m128i *)(wrap_p + 2*i), _mm_unpacklo_epi32(r0, r1));
+	_mm_storeu_si128((__m128i *)(wrap_p + 2*i + 4), _mm_unpackhi_epi32(r0, r1));
+}
+
+__attribute__((target("sse2")))
+static void juggle_sse2(int *wrap_p, int *block_p,
+			unsigned sub_len, unsigned sub_count)
+{
+	unsigned i, j;
+
+	for (i = 0; i + 4 <= sub_len; i += 4)
+		juggle4_sse2(wrap_p, block_p, i, sub_len, sub_count);
+	JUGGLE_TAIL();
+}
+
+/*
+ * AVX2 - 8 columns.  shuffle_ps works in 128-bit lanes, the
+ * permute fixes column order both ways.
+ */
+__attribute__((target("avx2")))
+static void juggle_avx2(int *wrap_p, int *block_p,
+			unsigned sub_len, unsigned sub_count)
+{
+	unsigned i, j;
+	__m256i r0, r1, r2, r3, w0, w1;
+	int *p;
+
+	for (i = 0; i + 8 <= sub_len; i += 8) {
+		w0 = _mm256_loadu_si256((const __m256i *)(wrap_p + 2*i));
+		w1 = _mm256_loadu_si256((const __m256i *)(wrap_p + 2*i + 8));
+		r0 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(w0),
+				_mm256_castsi256_ps(w1), _MM_SHUFFLE(2, 0, 2, 0)));
+		r1 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(w0),
+				_mm256_castsi256_ps(w1), _MM_SHUFFLE(3, 1, 3, 1)));
+		r0 = _mm256_permute4x64_epi64(r0, 0xD8);
+		r1 = _mm256_permute4x64_epi64(r1, 0xD8);
+		p = block_p + i;
+		for (j = 0; j < sub_count/2; j++) {
+			r2 = _mm256_loadu_si256((const __m256i *)p);
+			_mm256_storeu_si256((__m256i *)p, _mm256_add_epi32(
+				_mm256_add_epi32(r1, r1), _mm256_add_epi32(r0, r2)));
+			p += sub_len;
+			r3 = _mm256_loadu_si256((const __m256i *)p);
+			_mm256_storeu_si256((__m256i *)p, _mm256_sub_epi32(
+				_mm256_add_epi32(r2, r2), _mm256_add_epi32(r1, r3)));
+			p += sub_len;
+			r0 = r2;
+			r1 = r3;
+		}
+		r0 = _mm256_permute4x64_epi64(r0, 0xD8);
+		r1 = _mm256_permute4x64_epi64(r1, 0xD8);
+		_mm256_storeu_si256((__m256i *)(wrap_p + 2*i), _mm256_unpacklo_epi32(r0, r1));
+		_mm256_storeu_si256((__m256i *)(wrap_p + 2*i + 8), _mm256_unpackhi_epi32(r0, r1));
+	}
+	if (i + 4 <= sub_len) {
+		juggle4_sse2(wrap_p, block_p, i, sub_len, sub_count);
+		i += 4;
+	}
+	JUGGLE_TAIL();
+}
+
+#endif /* USE_X86 */
+
+#ifdef USE_NEON
+
+/*
+ * NEON - 8 samples per loop.  vmovn truncates, as scalar code.
+ */
+#define NEON_OUT(name, swap, bias) \
+static unsigned char *name(const int *src, unsigned char *dst, \
+			   unsigned n, unsigned shift) \
+{ \
+	int32x4_t sh = vdupq_n_s32(-(int)shift); \
+	int32x4_t a, b; \
+	uint16x8_t v; \
+	while (n >= 8) { \
+		a = vshlq_s32(vld1q_s32(src), sh); \
+		b = vshlq_s32(vld1q_s32(src + 4), sh); \
+		v = vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b))); \
+		if (bias) \
+			v = veorq_u16(v, vdupq_n_u16(0x8000)); \
+		if (swap) \
+			v = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v))); \
+		vst1q_u8(dst, vreinterpretq_u8_u16(v)); \
+		src += 8; \
+		dst += 16; \
+		n -= 8; \
+	} \
+	OUT_TAIL(swap, bias); \
+	return dst; \
+}
+
+NEON_OUT(out_s16le_neon, 0, 0)
+NEON_OUT(out_u16le_neon, 0, 1)
+NEON_OUT(out_s16be_neon, 1, 0)
+NEON_OUT(out_u16be_neon, 1, 1)
+
+/*
+ * 2-plane output, vld2 splits stereo pairs.
+ */
+static void planar2_s16_neon(const int *src, unsigned step, void **dst,
+			     unsigned nplanes, unsigned pos, unsigned n,
+			     unsigned shift)
+{
+	int16_t *l = (int16_t *)dst[0] + pos, *r = (int16_t *)dst[1] + pos;
+	int32x4_t sh = vdupq_n_s32(-(int)shift);
+	int32x4x2_t a, b;
+	int16x8_t v;
+	unsigned i = 0;
+
+	(void)nplanes;
+	if (step == 1) {
+		for (; i + 8 <= n; i += 8, src += 8) {
+			v = vcombine_s16(vmovn_s32(vshlq_s32(vld1q_s32(src), sh)),
+					 vmovn_s32(vshlq_s32(vld1q_s32(src + 4), sh)));
+			vst1q_s16(l + i, v);
+			vst1q_s16(r + i, v);
+		}
+	} else {
+		for (; i + 8 <= n; i += 8, src += 16) {
+			a = vld2q_s32(src);
+			b = vld2q_s32(src + 8);
+			vst1q_s16(l + i, vcombine_s16(vmovn_s32(vshlq_s32(a.val[0], sh)),
+						      vmovn_s32(vshlq_s32(b.val[0], sh))));
+			vst1q_s16(r + i, vcombine_s16(vmovn_s32(vshlq_s32(a.val[1], sh)),
+						      vmovn_s32(vshlq_s32(b.val[1], sh))));
+		}
+	}
+	PLANAR2_TAIL(TAIL_S16);
+}
+
+static void planar2_f32_neon(const int *src, unsigned step, void **dst,
+			     unsigned nplanes, unsigned pos, unsigned n,
+			     unsigned shift)
+{
+	float *l = (float *)dst[0] + pos, *r = (float *)dst[1] + pos;
+	float scale = 1.0f / (float)(32768u << shift);
+	float32x4_t v;
+	int32x4x2_t a;
+	unsigned i = 0;
+
+	(void)nplanes;
+	if (step == 1) {
+		for (; i + 4 <= n; i += 4, src += 4) {
+			v = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src)), scale);
+			vst1q_f32(l + i, v);
+			vst1q_f32(r + i, v);
+		}
+	} else {
+		for (; i + 4 <= n; i += 4, src += 8) {
+			a = vld2q_s32(src);
+			vst1q_f32(l + i, vmulq_n_f32(vcvtq_f32_s32(a.val[0]), scale));
+			vst1q_f32(r + i, vmulq_n_f32(vcvtq_f32_s32(a.val[1]), scale));
+		}
+	}
+	PLANAR2_TAIL(TAIL_F32);
+}
+
+/*
+ * juggle() across columns, vld2/vst2 split (r0, r1) pairs.
+ */
+static void juggle_neon(int *wrap_p, int *block_p,
+			unsigned sub_len, unsigned sub_count)
+{
+	unsigned i, j;
+	int32x4x2_t w;
+	int32x4_t r0, r1, r2, r3;
+	int *p;
+
+	for (i = 0; i + 4 <= sub_len; i += 4) {
+		w = vld2q_s32(wrap_p + 2*i);
+		r0 = w.val[0];
+		r1 = w.val[1];
+		p = block_p + i;
+		for (j = 0; j < sub_count/2; j++) {
+			r2 = vld1q_s32(p);
+			vst1q_s32(p, vaddq_s32(vaddq_s32(r1, r1), vaddq_s32(r0, r2)));
+			p += sub_len;
+			r3 = vld1q_s32(p);
+			vst1q_s32(p, vsubq_s32(vaddq_s32(r2, r2), vaddq_s32(r1, r3)));
+			p += sub_len;
+			r0 = r2;
+			r1 = r3;
+		}
+		w.val[0] = r0;
+		w.val[1] = r1;
+		vst2q_s32(wrap_p + 2*i, w);
+	}
+	JUGGLE_TAIL();
+}
+
+#endif /* USE_NEON */
+
+/*
+ * Replace scalar kernels with one set.  Fails without changes
+ * if the set is not built in or CPU does not support it.
+ */
+int acm_simd_use(ACMStream *acm, unsigned set)
+{
+	switch (set) {
+	case ACM_SIMD_NONE:
+		return ACM_OK;
+#ifdef USE_X86
+	case ACM_SIMD_AVX2:
+		if (!__builtin_cpu_supports("avx2"))
+			break;
+		acm->out_func[ACM_OUT_S16LE] = out_s16le_avx2;
+		acm->out_func[ACM_OUT_U16LE] = out_u16le_avx2;
+		acm->out_func[ACM_OUT_S16BE] = out_s16be_avx2;
+		acm->out_func[ACM_OUT_U16BE] = out_u16be_avx2;
+		acm->juggle = juggle_avx2;
+		acm->planar2_func[ACM_SAMPLE_S16] = planar2_s16_sse2;
+		acm->planar2_func[ACM_SAMPLE_F32] = planar2_f32_sse2;
+		return ACM_OK;
+	case ACM_SIMD_SSE2:
+		if (!__builtin_cpu_supports("sse2"))
+			break;
+		acm->out_func[ACM_OUT_S16LE] = out_s16le_sse2;
+		acm->out_func[ACM_OUT_U16LE] = out_u16le_sse2;
+		acm->out_func[ACM_OUT_S16BE] = out_s16be_sse2;
+		acm->out_func[ACM_OUT_U16BE] = out_u16be_sse2;
+		acm->juggle = juggle_sse2;
+		acm->planar2_func[ACM_SAMPLE_S16] = planar2_s16_sse2;
+		acm->planar2_func[ACM_SAMPLE_F32] = planar2_f32_sse2;
+		return ACM_OK;
+#endif
+#ifdef USE_NEON
+	case ACM_SIMD_NEON:
+		acm->out_func[ACM_OUT_S16LE] = out_s16le_neon;
+		acm->out_func[ACM_OUT_U16LE] = out_u16le_neon;
+		acm->out_func[ACM_OUT_S16BE] = out_s16be_neon;
+		acm->out_func[ACM_OUT_U16BE] = out_u16be_neon;
+		acm->juggle = juggle_neon;
+		acm->planar2_func[ACM_SAMPLE_S16] = planar2_s16_neon;
+		acm->planar2_func[ACM_SAMPLE_F32] = planar2_f32_neon;
+		return ACM_OK;
+#endif
+	}
+	return ACM_ERR_OTHER;
+}
+
+/*
+ * Pick best kernels for this CPU.
+ */
+void acm_simd_init(ACMStream *acm)
+{
+	if (acm_simd_use(acm, ACM_SIMD_AVX2) == ACM_OK)
+		return;
+	if (acm_simd_use(acm, ACM_SIMD_SSE2) == ACM_OK)
+		return;
+	acm_simd_use(acm, ACM_SIMD_NEON);
+}
@@ -0,0 +1,168 @@
+/*
+ * Synthetic ACM streams for benchmarks and tests.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "streamgen.h"
+
+const unsigned gen_valid_fillers[] = {
+	0, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+	17, 18, 19, 20, 21, 22, 23, 24, 26, 27, 29
+};
+const unsigned gen_num_fillers = sizeof(gen_valid_fillers) / sizeof(gen_valid_fillers[0]);
+
+unsigned gen_rnd(struct gen_writer *w, unsigned n)
+{
+	w->seed = w->seed * 1103515245 + 12345;
+	return (unsigned)(((uint64_t)(w->seed >> 8) * n) >> 24);
+}
+
+static void put_bits(struct gen_writer *w, unsigned val, unsigned bits)
+{
+	w->acc |= (uint64_t)(val & ((1u << bits) - 1)) << w->nbits;
+	w->nbits += bits;
+	w->total_bits += bits;
+	while (w->nbits >= 8) {
+		if (w->len == w->max) {
+			w->max = w->max ? w->max * 2 : 64 * 1024;
+			w->buf = (unsigned char *)realloc(w->buf, w->max);
+			if (!w->buf) {
+				fprintf(stderr, "streamgen: out of memory\n");
+				exit(1);
+			}
+		}
+		w->buf[w->len++] = w->acc & 0xFF;
+		w->acc >>= 8;
+		w->nbits -= 8;
+	}
+}
+
+/* value code after first 1 bit(s) of k* fillers */
+static void put_kval(struct gen_writer *w, unsigned ind)
+{
+	switch (ind) {
+	case 17: case 18:
+		put_bits(w, gen_rnd(w, 2), 1);
+		break;
+	case 20: case 21:
+		put_bits(w, gen_rnd(w, 4), 2);
+		break;
+	case 23: case 24:
+		if (gen_rnd(w, 2)) {
+			put_bits(w, 0, 1);
+			put_bits(w, gen_rnd(w, 2), 1);
+		} else {
+			put_bits(w, 1, 1);
+			put_bits(w, gen_rnd(w, 4), 2);
+		}
+		break;
+	case 26: case 27:
+		put_bits(w, gen_rnd(w, 8), 3);
+		break;
+	}
+}
+
+/* random column for filler ind, see filler_list in decode.c */
+static void put_column(struct gen_writer *w, unsigned ind, unsigned rows)
+{
+	unsigned i = 0;
+
+	put_bits(w, ind, 5);
+	switch (ind) {
+	case 0:
+		break;
+	case 17: case 20: case 23: case 26:
+		/* '0' is two zeroes, '10' one zero */
+		while (i < rows) {
+			switch (gen_rnd(w, 3)) {
+			case 0:
+				put_bits(w, 0, 1);
+				i += 2;
+				break;
+			case 1:
+				put_bits(w, 1, 2);
+				i++;
+				break;
+			default:
+				put_bits(w, 3, 2);
+				put_kval(w, ind);
+				i++;
+			}
+		}
+		break;
+	case 18: case 21: case 24: case 27:
+		for (; i < rows; i++) {
+			if (gen_rnd(w, 2)) {
+				put_bits(w, 1, 1);
+				put_kval(w, ind);
+			} else
+				put_bits(w, 0, 1);
+		}
+		break;
+	case 19:
+		for (; i < rows; i += 3)
+			put_bits(w, gen_rnd(w, 27), 5);
+		break;
+	case 22:
+		for (; i < rows; i += 3)
+			put_bits(w, gen_rnd(w, 125), 7);
+		break;
+	case 29:
+		for (; i < rows; i += 2)
+			put_bits(w, gen_rnd(w, 121), 7);
+		break;
+	default:
+		for (; i < rows; i++)
+			put_bits(w, gen_rnd(w, 1u << ind), ind);
+	}
+}
+
+void gen_stream(struct gen_writer *w, unsigned level, unsigned rows,
+		unsigned samples, unsigned chans, int ind)
+{
+	unsigned cols = 1 << level, blocks, b, c;
+
+	memset(w, 0, sizeof(*w));
+	w->seed = level * 32 + ind + 1 + (samples << 10);
+
+	put_bits(w, ACM_ID, 24);
+	put_bits(w, 1, 8);
+	put_bits(w, samples & 0xFFFF, 16);
+	put_bits(w, samples >> 16, 16);
+	put_bits(w, chans, 16);
+	put_bits(w, 22050, 16);
+	put_bits(w, level, 4);
+	put_bits(w, rows, 12);
+
+	blocks = (samples + rows * cols - 1) / (rows * cols);
+	for (b = 0; b < blocks; b++) {
+		put_bits(w, 15, 4);
+		put_bits(w, 1 + gen_rnd(w, 64), 16);
+		for (c = 0; c < cols; c++)
+			put_column(w, ind < 0 ? gen_valid_fillers[gen_rnd(w, gen_num_fillers)]
+				   : (unsigned)ind, rows);
+	}
+	put_bits(w, 0, 7);
+}
@@ -0,0 +1,49 @@
+/*
+ * Synthetic ACM streams for benchmarks and tests.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef __STREAMGEN_H
+#define __STREAMGEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct gen_writer {
+	unsigned char *buf;
+	size_t len, max;
+	uint64_t acc;
+	unsigned nbits;
+	uint64_t total_bits;
+	uint32_t seed;
+};
+
+/* filler indices that may appear in a valid stream */
+extern const unsigned gen_valid_fillers[];
+extern const unsigned gen_num_fillers;
+
+/* pseudo-random number below n */
+unsigned gen_rnd(struct gen_writer *w, unsigned n);
+
+/*
+ * Stream of samples values with random columns, header says
+ * chans channels.  ind < 0 mixes all valid fillers.  Same
+ * arguments give same bytes.  Exits on out of memory.
+ */
+void gen_stream(struct gen_writer *w, unsigned level, unsigned rows,
+		unsigned samples, unsigned chans, int ind);
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Decoded PCM cache.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Generated streams are written to files and opened through
+ * acm_open_cached().  First calls come from several threads at
+ * once, with cache still disabled.  Then second open is a hit, budget for two files
+ * evicts the oldest of three, a stream of an evicted entry keeps
+ * working until acm_close(), and a truncated file is given as a
+ * plain stream without caching it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+#include "streamgen.h"
+
+#define NFILES		3
+#define SAMPLES		60000
+#define OUT_MAX		(SAMPLES + 2)
+
+static const char *names[NFILES] = {
+	"test_cache_0.acm", "test_cache_1.acm", "test_cache_2.acm"
+};
+static const char *trunc_name = "test_cache_t.acm";
+
+static int16_t ref[NFILES][OUT_MAX];
+static int ref_len[NFILES];
+static unsigned failed;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "line %d: %s\n", __LINE__, #cond); \
+		failed++; \
+	} \
+} while (0)
+
+static int write_file(const char *fn, const void *data, size_t len)
+{
+	FILE *f = fopen(fn, "wb");
+	size_t n;
+
+	if (!f)
+		return -1;
+	n = fwrite(data, 1, len, f);
+	if (fclose(f) != 0 || n != len)
+		return -1;
+	return 0;
+}
+
+/* read whole stream, compare with ref of file i */
+static int same_data(ACMStream *acm, unsigned i)
+{
+	int16_t *out = (int16_t *)malloc(OUT_MAX * sizeof(int16_t));
+	int got, ok;
+
+	if (!out)
+		return 0;
+	got = acm_read_loop(acm, out, OUT_MAX * sizeof(int16_t), 0, 2, 1);
+	ok = got == ref_len[i] && memcmp(out, ref[i], got) == 0;
+	free(out);
+	return ok;
+}
+
+struct first {
+	unsigned id;
+	acm_thread *tid;
+	int ok;
+};
+
+static void first_use(void *arg)
+{
+	struct first *f = (struct first *)arg;
+	ACMStream *acm;
+
+	if (acm_open_cached(&acm, names[f->id % NFILES], 0) < 0)
+		return;
+	f->ok = same_data(acm, f->id % NFILES);
+	acm_close(acm);
+}
+
+static ACMStream *open_cached(const char *fn)
+{
+	ACMStream *acm;
+	int err = acm_open_cached(&acm, fn, 0);
+	if (err < 0) {
+		fprintf(stderr, "%s: cannot open: %d\n", fn, err);
+		exit(1);
+	}
+	return acm;
+}
+
+int main(void)
+{
+	struct acm_cache_stats st;
+	struct gen_writer w;
+	ACMStream *acm, *a2, *keep;
+	struct first fu[4];
+	unsigned i;
+	size_t entry_bytes = 0;
+
+	for (i = 0; i < NFILES; i++) {
+		gen_stream(&w, 4 + i, 64, SAMPLES, 2, -1);
+		if (write_file(names[i], w.buf, w.len) < 0) {
+			fprintf(stderr, "%s: cannot write\n", names[i]);
+			return 1;
+		}
+		if (i == 0 && write_file(trunc_name, w.buf, w.len / 2) < 0) {
+			fprintf(stderr, "%s: cannot write\n", trunc_name);
+			return 1;
+		}
+		if (acm_open_memory(&acm, w.buf, w.len, 0) < 0)
+			return 1;
+		ref_len[i] = acm_read_loop(acm, ref[i], sizeof(ref[i]), 0, 2, 1);
+		entry_bytes = (size_t)acm->total_values * sizeof(int);
+		acm_close(acm);
+		free(w.buf);
+	}
+
+	/* race on first use, disabled cache gives plain streams */
+	for (i = 0; i < 4; i++) {
+		fu[i].id = i;
+		fu[i].ok = 0;
+		fu[i].tid = acm_thread_start(first_use, &fu[i]);
+	}
+	for (i = 0; i < 4; i++) {
+		if (fu[i].tid)
+			acm_thread_join(fu[i].tid);
+		else
+			first_use(&fu[i]);
+		CHECK(fu[i].ok);
+	}
+	acm_cache_get_stats(&st);
+	CHECK(st.misses == 0 && st.hits == 0 && st.entries == 0);
+
+	/* room for two entries */
+	CHECK(acm_cache_set_budget(2 * entry_bytes + entry_bytes / 2) == 0);
+
+	/* miss, then hit with same data */
+	acm = open_cached(names[0]);
+	CHECK(same_data(acm, 0));
+	a2 = open_cached(names[0]);
+	CHECK(same_data(a2, 0));
+	acm_cache_get_stats(&st);
+	CHECK(st.misses == 1 && st.hits == 1 && st.entries == 1);
+	CHECK(st.bytes == entry_bytes);
+	acm_close(a2);
+	acm_close(acm);
+
+	/* keep a stream of file 0 open while it is evicted */
+	keep = open_cached(names[0]);
+	acm = open_cached(names[1]);
+	acm_close(acm);
+	acm = open_cached(names[2]);
+	acm_close(acm);
+	acm_cache_get_stats(&st);
+	CHECK(st.evictions == 1 && st.entries == 2);
+	CHECK(st.hits == 2 && st.misses == 3);
+	CHECK(same_data(keep, 0));
+	CHECK(acm_seek_pcm(keep, 1000) == 1000);
+	acm_close(keep);
+
+	/* evicted entry is decoded again */
+	acm = open_cached(names[0]);
+	CHECK(same_data(acm, 0));
+	acm_close(acm);
+	acm_cache_get_stats(&st);
+	CHECK(st.misses == 4 && st.evictions == 2 && st.entries == 2);
+
+	/* truncated file: plain stream, not cached */
+	acm = open_cached(trunc_name);
+	CHECK(acm->pcm_data == NULL);
+	acm_close(acm);
+	acm_cache_get_stats(&st);
+	CHECK(st.misses == 5 && st.entries == 2 && st.evictions == 2);
+	acm = open_cached(trunc_name);
+	acm_close(acm);
+	acm_cache_get_stats(&st);
+	CHECK(st.misses == 6 && st.hits == 2);
+
+	/* budget 0 drops everything */
+	CHECK(acm_cache_set_budget(0) == 0);
+	acm_cache_get_stats(&st);
+	CHECK(st.entries == 0 && st.bytes == 0);
+
+	for (i = 0; i < NFILES; i++)
+		remove(names[i]);
+	remove(trunc_name);
+
+	printf("cache: %s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
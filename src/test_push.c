@@ -0,0 +1,143 @@
+/*
+ * Push mode against normal decode.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Generated streams are fed in chunks of random size, from single
+ * bytes to several blocks, and read after each feed until reads
+ * ask for more.  Output must be same as from acm_open_memory().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "streamgen.h"
+
+#define OUT_MAX		(2 * 150000)
+
+struct push_case {
+	unsigned level, rows, chans;
+};
+
+static const struct push_case cases[] = {
+	{ 0, 7, 2 },
+	{ 0, 16, 1 },
+	{ 2, 300, 1 },
+	{ 4, 100, 2 },
+	{ 7, 30, 2 },
+	{ 10, 8, 1 },
+	{ 12, 2, 2 },
+};
+
+/* read what fed data gives, returns bytes or error code */
+static int drain(ACMStream *acm, int16_t *out, unsigned *got)
+{
+	int res;
+
+	while (1) {
+		res = acm_read_loop(acm, (unsigned char *)out + *got,
+				    OUT_MAX * ACM_WORD - *got, 0, 2, 1);
+		if (res <= 0)
+			return res;
+		*got += res;
+	}
+}
+
+/* feed w in chunks up to max_chunk bytes, 0 if output matches */
+static int check_push(const struct gen_writer *w, struct gen_writer *rnd,
+		      unsigned max_chunk, const int16_t *ref, int ref_len)
+{
+	static int16_t out[OUT_MAX];
+	unsigned pos = 0, got = 0, n;
+	ACMStream *acm;
+	int res;
+
+	if (acm_open_push(&acm, 0, NULL) < 0)
+		return 1;
+	while (pos < w->len) {
+		n = 1 + gen_rnd(rnd, max_chunk);
+		if (n > w->len - pos)
+			n = w->len - pos;
+		if (acm_feed(acm, w->buf + pos, n) < 0)
+			break;
+		pos += n;
+		res = drain(acm, out, &got);
+		/* stream may end before input does */
+		if (res == 0)
+			break;
+		if (res != ACM_NEED_MORE_DATA) {
+			fprintf(stderr, "read after %u bytes gave %d\n", pos, res);
+			break;
+		}
+	}
+	acm_feed(acm, NULL, 0);
+	res = drain(acm, out, &got);
+	acm_close(acm);
+
+	if (res != 0 || got != (unsigned)ref_len || memcmp(out, ref, got) != 0) {
+		fprintf(stderr, "chunks up to %u: %u bytes, want %d, end %d\n",
+			max_chunk, got, ref_len, res);
+		return 1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	static const unsigned chunks[] = { 1, 7, 100, 5000, 100000 };
+	static int16_t ref[OUT_MAX];
+	unsigned c, k, failed = 0, tested = 0;
+
+	for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		const struct push_case *pc = &cases[c];
+		struct gen_writer w, rnd;
+		ACMStream *acm;
+		int ref_len;
+
+		gen_stream(&w, pc->level, pc->rows, 100000 + c * 1231, pc->chans, -1);
+		memset(&rnd, 0, sizeof(rnd));
+		rnd.seed = c + 1;
+
+		if (acm_open_memory(&acm, w.buf, w.len, 0) < 0)
+			return 1;
+		ref_len = acm_read_loop(acm, ref, sizeof(ref), 0, 2, 1);
+		acm_close(acm);
+		if (ref_len <= 0) {
+			fprintf(stderr, "level %u: decode failed: %d\n", pc->level, ref_len);
+			return 1;
+		}
+
+		for (k = 0; k < sizeof(chunks) / sizeof(chunks[0]); k++) {
+			if (check_push(&w, &rnd, chunks[k], ref, ref_len)) {
+				fprintf(stderr, "level %u rows %u chans %u: FAILED\n",
+					pc->level, pc->rows, pc->chans);
+				failed++;
+			}
+			tested++;
+		}
+		free(w.buf);
+	}
+
+	printf("%u push decodes: %s\n", tested, failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Reads of stereo streams whose blocks split frames.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Level 0 with odd acm_rows gives odd block_len, so on 2 channels
+ * every other block ends inside a frame.  acm_read_loop(),
+ * acm_read_frames() in interleaved and planar form and
+ * acm_read_float() must all reach acm_pcm_total() frames, with
+ * the values acm_read_block_ptr() gives word by word.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "streamgen.h"
+
+static uint32_t seed = 1;
+
+/* xorshift32 */
+static uint32_t rnd32(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static ACMStream *open_gen(const struct gen_writer *w, int force_chans)
+{
+	ACMStream *acm;
+	int err = acm_open_memory(&acm, w->buf, w->len, force_chans);
+	if (err < 0) {
+		fprintf(stderr, "cannot open stream: %d\n", err);
+		exit(1);
+	}
+	return acm;
+}
+
+/* all words, as s16 in native order, returns frame count */
+static unsigned decode_ref(const struct gen_writer *w, int force_chans,
+			   int16_t *dst, unsigned max)
+{
+	ACMStream *acm = open_gen(w, force_chans);
+	unsigned got = 0, frames, i;
+	const int *src;
+	int n;
+
+	while ((n = acm_read_block_ptr(acm, &src, max - got)) > 0) {
+		for (i = 0; i < (unsigned)n; i++)
+			dst[got + i] = src[i] >> acm->info.acm_level;
+		got += n;
+	}
+	frames = acm_pcm_total(acm);
+	acm_close(acm);
+	if (got / 2 != frames) {
+		fprintf(stderr, "block_ptr: %u words for %u frames\n", got, frames);
+		exit(1);
+	}
+	return frames;
+}
+
+static unsigned check_stream(const struct gen_writer *w, int force_chans,
+			     const char *name)
+{
+	static int16_t ref[2 * 40000], out[2 * 40000], left[40000], right[40000];
+	static float fout[2 * 40000];
+	static const ACMFormat s16 = { ACM_SAMPLE_S16, 0, 0 };
+	static const ACMFormat p16 = { ACM_SAMPLE_S16, 1, 0 };
+	unsigned frames, got, i, failed = 0;
+	ACMStream *acm;
+	int n;
+
+	frames = decode_ref(w, force_chans, ref, sizeof(ref) / sizeof(ref[0]));
+
+	/* whole buffer at once */
+	acm = open_gen(w, force_chans);
+	n = acm_read_loop(acm, out, sizeof(out), 0, 2, 1);
+	if (n != (int)frames * 4 || memcmp(out, ref, n) != 0) {
+		fprintf(stderr, "%s: acm_read_loop: %d bytes, want %u\n", name, n, frames * 4);
+		failed++;
+	}
+	acm_close(acm);
+
+	/* one frame per call */
+	acm = open_gen(w, force_chans);
+	for (got = 0; got < frames; got++) {
+		if (acm_read(acm, out + 2 * got, 4, 0, 2, 1) != 4)
+			break;
+	}
+	if (got != frames || memcmp(out, ref, frames * 4) != 0) {
+		fprintf(stderr, "%s: acm_read of 4 bytes: %u frames, want %u\n",
+			name, got, frames);
+		failed++;
+	}
+	acm_close(acm);
+
+	/* random counts, interleaved */
+	acm = open_gen(w, force_chans);
+	for (got = 0; got < frames; got += n) {
+		n = acm_read_frames(acm, out + 2 * got, 1 + rnd32() % 700, &s16);
+		if (n <= 0)
+			break;
+	}
+	if (got != frames || memcmp(out, ref, frames * 4) != 0) {
+		fprintf(stderr, "%s: acm_read_frames: %u frames, want %u\n",
+			name, got, frames);
+		failed++;
+	}
+	acm_close(acm);
+
+	/* random counts, planar */
+	acm = open_gen(w, force_chans);
+	for (got = 0; got < frames; got += n) {
+		void *p[2];
+		p[0] = left + got;
+		p[1] = right + got;
+		n = acm_read_frames(acm, p, 1 + rnd32() % 700, &p16);
+		if (n <= 0)
+			break;
+	}
+	for (i = 0; i < got && i < frames; i++) {
+		if (left[i] != ref[2 * i] || right[i] != ref[2 * i + 1])
+			break;
+	}
+	if (got != frames || i != frames) {
+		fprintf(stderr, "%s: planar acm_read_frames: %u frames, want %u\n",
+			name, got, frames);
+		failed++;
+	}
+	acm_close(acm);
+
+	/* floats, odd word counts ask for less than a frame at times;
+	 * s16 output keeps only the low bits of large values */
+	acm = open_gen(w, force_chans);
+	for (got = 0; got < 2 * frames; got += n) {
+		n = acm_read_float(acm, fout + got, 2 + rnd32() % 500);
+		if (n <= 0)
+			break;
+	}
+	for (i = 0; i < got && i < 2 * frames; i++) {
+		if ((int16_t)(int)(fout[i] * 32768.0f) != ref[i])
+			break;
+	}
+	if (got != 2 * frames || i != got) {
+		fprintf(stderr, "%s: acm_read_float: %u words, want %u\n",
+			name, got, 2 * frames);
+		failed++;
+	}
+	acm_close(acm);
+
+	return failed;
+}
+
+int main(void)
+{
+	static const unsigned rows_list[] = { 1, 3, 5, 63, 511, 4095 };
+	struct gen_writer w;
+	unsigned r, k, failed = 0, tested = 0;
+	char name[64];
+
+	for (r = 0; r < sizeof(rows_list) / sizeof(rows_list[0]); r++) {
+		unsigned rows = rows_list[r];
+		for (k = 0; k < 4; k++) {
+			/* odd and even sample counts, many blocks */
+			unsigned samples = rows * (3 + k * 5) + k;
+			if (samples > 2 * 40000)
+				samples = 2 * 40000 - k;
+
+			/* stereo header */
+			gen_stream(&w, 0, rows, samples, 2, -1);
+			sprintf(name, "stereo rows %u samples %u", rows, samples);
+			failed += check_stream(&w, 0, name);
+			/* mono header, opened as 2 channels */
+			gen_stream(&w, 0, rows, samples, 1, -1);
+			sprintf(name, "mono rows %u samples %u", rows, samples);
+			failed += check_stream(&w, 0, name);
+			sprintf(name, "forced rows %u samples %u", rows, samples);
+			failed += check_stream(&w, 2, name);
+			free(w.buf);
+			tested += 3;
+		}
+	}
+
+	printf("%u streams with split frames: %s\n", tested, failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
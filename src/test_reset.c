@@ -0,0 +1,320 @@
+/*
+ * acm_reset() and allocator callbacks.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * One stream is reset through generated streams whose buffers
+ * grow and shrink, and each must decode and seek as on a fresh
+ * stream.  Its allocator keeps a list of live blocks: free_func
+ * must get only those, and nothing may be left after acm_close().
+ * Same runs again with an arena allocator without free_func,
+ * where a plain free() of its memory would crash.  Seek index
+ * saved and loaded through idxfile.c also uses the allocator.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "streamgen.h"
+
+#define OUT_MAX		(2 * 120000)
+#define MAX_LIVE	256
+#define ARENA_SIZE	(16 * 1024 * 1024)
+
+struct reset_case {
+	unsigned level, rows, chans;
+};
+
+/* buffers go up and down, wrapbuf comes and goes */
+static const struct reset_case cases[] = {
+	{ 2, 1, 1 },
+	{ 10, 16, 2 },
+	{ 4, 300, 1 },
+	{ 12, 2, 2 },
+	{ 0, 50, 2 },
+	{ 8, 1, 2 },
+	{ 7, 30, 1 },
+};
+#define NCASES	(sizeof(cases) / sizeof(cases[0]))
+
+static const char *idx_name = "test_reset.acm";
+
+struct tracker {
+	void *live[MAX_LIVE];
+	unsigned nlive, allocs, frees, bad_frees;
+	/* arena mode, no free_func */
+	unsigned char *arena;
+	size_t arena_used;
+};
+
+struct mem_src {
+	const unsigned char *buf;
+	size_t len, pos;
+	int closed;
+};
+
+static unsigned failed;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "line %d: %s\n", __LINE__, #cond); \
+		failed++; \
+	} \
+} while (0)
+
+static void *track_alloc(size_t size, void *arg)
+{
+	struct tracker *t = (struct tracker *)arg;
+	void *p;
+
+	if (t->arena) {
+		size = (size + 15) & ~(size_t)15;
+		if (size > ARENA_SIZE - t->arena_used)
+			return NULL;
+		p = t->arena + t->arena_used;
+		t->arena_used += size;
+		t->allocs++;
+		return p;
+	}
+	if (t->nlive == MAX_LIVE || (p = malloc(size)) == NULL)
+		return NULL;
+	t->live[t->nlive++] = p;
+	t->allocs++;
+	return p;
+}
+
+static void track_free(void *ptr, void *arg)
+{
+	struct tracker *t = (struct tracker *)arg;
+	unsigned i;
+
+	for (i = 0; i < t->nlive; i++) {
+		if (t->live[i] == ptr) {
+			t->live[i] = t->live[--t->nlive];
+			t->frees++;
+			free(ptr);
+			return;
+		}
+	}
+	t->bad_frees++;
+}
+
+static int src_read(void *dst, int size, int n, void *arg)
+{
+	struct mem_src *s = (struct mem_src *)arg;
+	size_t len = (size_t)size * n;
+
+	if (len > s->len - s->pos)
+		len = s->len - s->pos;
+	memcpy(dst, s->buf + s->pos, len);
+	s->pos += len;
+	return (int)len;
+}
+
+static int src_seek(void *arg, int offset, int whence)
+{
+	struct mem_src *s = (struct mem_src *)arg;
+	long pos = offset;
+
+	if (whence == SEEK_CUR)
+		pos += (long)s->pos;
+	else if (whence == SEEK_END)
+		pos += (long)s->len;
+	if (pos < 0 || (size_t)pos > s->len)
+		return -1;
+	s->pos = pos;
+	return 0;
+}
+
+static int src_close(void *arg)
+{
+	((struct mem_src *)arg)->closed++;
+	return 0;
+}
+
+static int src_length(void *arg)
+{
+	return (int)((struct mem_src *)arg)->len;
+}
+
+static int write_file(const char *fn, const void *data, size_t len)
+{
+	FILE *f = fopen(fn, "wb");
+	size_t n;
+
+	if (!f)
+		return -1;
+	n = fwrite(data, 1, len, f);
+	if (fclose(f) != 0 || n != len)
+		return -1;
+	return 0;
+}
+
+/* whole decode, then random seeks through index, 0 if same as ref */
+static int check_stream(ACMStream *acm, const int16_t *ref, int ref_len,
+			struct gen_writer *rnd)
+{
+	static int16_t out[OUT_MAX];
+	unsigned chans = acm_channels(acm), total = acm_pcm_total(acm);
+	unsigned i, pos, n;
+	int got;
+
+	got = acm_read_loop(acm, out, sizeof(out), 0, 2, 1);
+	if (got != ref_len || memcmp(out, ref, got) != 0)
+		return 1;
+	if (acm_enable_seek_index(acm) < 0)
+		return 1;
+	for (i = 0; i < 20; i++) {
+		pos = gen_rnd(rnd, total);
+		n = total - pos < 200 ? total - pos : 200;
+		if (acm_seek_pcm(acm, pos) != (int)pos)
+			return 1;
+		got = acm_read_loop(acm, out, n * chans * ACM_WORD, 0, 2, 1);
+		if (got != (int)(n * chans * ACM_WORD)
+		    || memcmp(out, ref + pos * chans, got) != 0)
+			return 1;
+	}
+	return 0;
+}
+
+/* reset through all cases with allocator of t */
+static void run(struct tracker *t, struct gen_writer *w, int16_t **ref,
+		int *ref_len)
+{
+	struct mem_src src[NCASES];
+	struct gen_writer rnd;
+	acm_io_callbacks io;
+	ACMOptions opts;
+	ACMStream *acm;
+	unsigned i, round;
+	int err;
+
+	memset(&io, 0, sizeof(io));
+	io.read_func = src_read;
+	io.seek_func = src_seek;
+	io.close_func = src_close;
+	io.get_length_func = src_length;
+	memset(&opts, 0, sizeof(opts));
+	opts.alloc_func = track_alloc;
+	opts.free_func = t->arena ? NULL : track_free;
+	opts.alloc_arg = t;
+	memset(&rnd, 0, sizeof(rnd));
+	rnd.seed = 3;
+	memset(src, 0, sizeof(src));
+	for (i = 0; i < NCASES; i++) {
+		src[i].buf = w[i].buf;
+		src[i].len = w[i].len;
+	}
+
+	err = acm_open_decoder_ex(&acm, &src[0], io, 0, &opts);
+	CHECK(err == 0);
+	if (err < 0)
+		return;
+	CHECK(check_stream(acm, ref[0], ref_len[0], &rnd) == 0);
+
+	/* each case after each other one, forward then back */
+	for (round = 0; round < 2; round++) {
+		for (i = 1; i < 2 * NCASES; i++) {
+			unsigned c = round ? (2 * NCASES - i) % NCASES : i % NCASES;
+			src[c].pos = 0;
+			err = acm_reset(acm, &src[c]);
+			CHECK(err == 0);
+			if (err < 0)
+				return;
+			if (check_stream(acm, ref[c], ref_len[c], &rnd)) {
+				fprintf(stderr, "round %u: level %u rows %u after reset differs\n",
+					round, cases[c].level, cases[c].rows);
+				failed++;
+			}
+		}
+	}
+
+	/* saved and loaded index, case 1 */
+	src[1].pos = 0;
+	CHECK(acm_reset(acm, &src[1]) == 0);
+	CHECK(acm_save_index(acm, idx_name) == 0);
+	src[1].pos = 0;
+	CHECK(acm_reset(acm, &src[1]) == 0);
+	CHECK(acm_load_index(acm, idx_name) == 0);
+	CHECK(acm->seek_idx_len > 0);
+	CHECK(check_stream(acm, ref[1], ref_len[1], &rnd) == 0);
+
+	acm_close(acm);
+	for (i = 0; i < NCASES; i++)
+		CHECK(src[i].closed >= 1);
+}
+
+int main(void)
+{
+	static int16_t ref_buf[NCASES][OUT_MAX];
+	struct gen_writer w[NCASES];
+	int16_t *ref[NCASES];
+	int ref_len[NCASES];
+	struct tracker t;
+	ACMStream *acm;
+	char *idxfn;
+	unsigned i;
+
+	for (i = 0; i < NCASES; i++) {
+		const struct reset_case *rc = &cases[i];
+		gen_stream(&w[i], rc->level, rc->rows,
+			   (rc->rows << rc->level) * 5 + 20000 + i * 777, rc->chans, -1);
+		if (acm_open_memory(&acm, w[i].buf, w[i].len, 0) < 0)
+			return 1;
+		ref[i] = ref_buf[i];
+		ref_len[i] = acm_read_loop(acm, ref[i], OUT_MAX * ACM_WORD, 0, 2, 1);
+		acm_close(acm);
+		CHECK(ref_len[i] > 0);
+	}
+	/* index is keyed on file size and mtime */
+	if (write_file(idx_name, w[1].buf, w[1].len) < 0) {
+		fprintf(stderr, "%s: cannot write\n", idx_name);
+		return 1;
+	}
+
+	/* every free must match an alloc */
+	memset(&t, 0, sizeof(t));
+	run(&t, w, ref, ref_len);
+	CHECK(t.allocs > 0 && t.allocs == t.frees);
+	CHECK(t.nlive == 0 && t.bad_frees == 0);
+
+	/* arena, freed all at once */
+	memset(&t, 0, sizeof(t));
+	t.arena = (unsigned char *)malloc(ARENA_SIZE);
+	if (!t.arena)
+		return 1;
+	run(&t, w, ref, ref_len);
+	CHECK(t.allocs > 0);
+	free(t.arena);
+
+	idxfn = acm_index_filename(idx_name);
+	if (idxfn)
+		remove(idxfn);
+	free(idxfn);
+	remove(idx_name);
+	for (i = 0; i < NCASES; i++)
+		free(w[i].buf);
+
+	printf("reset: %s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
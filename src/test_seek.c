@@ -0,0 +1,249 @@
+/*
+ * Seeks against full decode.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * A seek into a block juggles it only up to the band of target,
+ * see acm_seek_block().  Data after the seek must still be what a
+ * full decode gives there.  Targets are put around band and block
+ * edges and at random, on a fresh stream and on one that jumps
+ * back and forth.
+ *
+ * Then random seeks go through no index, lazy index and one built
+ * up front, also on streams where wrapbuf carries over blocks
+ * (level > 1 with single row), which the index must save.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "streamgen.h"
+
+/* frames compared after each seek */
+#define CHECK_FRAMES	300
+
+/* rows of a juggle pass, as in decode.c */
+#define JUGGLE_STEP(lev)	((lev) > 9 ? 1 : (2048 >> (lev)) - 2)
+
+struct seek_case {
+	unsigned level, rows, chans;
+};
+
+static const struct seek_case cases[] = {
+	{ 1, 3000, 1 },
+	{ 1, 1500, 2 },
+	{ 2, 1100, 2 },
+	{ 3, 600, 1 },
+	{ 5, 200, 2 },
+	{ 7, 40, 1 },
+	{ 8, 20, 2 },
+	{ 10, 8, 2 },
+	{ 12, 4, 1 },
+};
+
+/* index modes for random seeks */
+enum { IDX_NONE, IDX_LAZY, IDX_FULL, IDX_MODES };
+
+static const struct seek_case idx_cases[] = {
+	{ 2, 1, 1 },
+	{ 4, 1, 2 },
+	{ 8, 1, 2 },
+	{ 3, 2, 1 },
+	{ 6, 16, 2 },
+	{ 10, 3, 1 },
+};
+
+static ACMStream *open_gen(const struct gen_writer *w)
+{
+	ACMStream *acm;
+	int err = acm_open_memory(&acm, w->buf, w->len, 0);
+	if (err < 0) {
+		fprintf(stderr, "cannot open stream: %d\n", err);
+		exit(1);
+	}
+	return acm;
+}
+
+/* seek to pos and compare frames after it with ref, 0 if same */
+static int check_at(ACMStream *acm, const int16_t *ref, unsigned total,
+		    unsigned pos)
+{
+	static int16_t buf[CHECK_FRAMES * 2];
+	unsigned chans = acm_channels(acm), n;
+	int res;
+
+	res = acm_seek_pcm(acm, pos);
+	if (res != (int)pos) {
+		fprintf(stderr, "seek to %u gave %d\n", pos, res);
+		return 1;
+	}
+	n = total - pos < CHECK_FRAMES ? total - pos : CHECK_FRAMES;
+	res = acm_read_loop(acm, buf, n * chans * ACM_WORD, 0, 2, 1);
+	if (res != (int)(n * chans * ACM_WORD)
+	    || memcmp(buf, ref + pos * chans, res) != 0) {
+		fprintf(stderr, "data after seek to %u differs\n", pos);
+		return 1;
+	}
+	return 0;
+}
+
+/* targets around band and block edges, then random ones */
+static unsigned make_targets(const ACMStream *acm, struct gen_writer *w,
+			     unsigned total, unsigned *pos, unsigned max)
+{
+	unsigned level = acm->info.acm_level, rows = acm->info.acm_rows;
+	unsigned chans = acm->info.channels, step = JUGGLE_STEP(level);
+	unsigned nblocks = total * chans / acm->block_len, b, row, n = 0;
+	int d;
+
+	for (b = 0; b < nblocks && b < 3; b++) {
+		for (row = 0; row <= rows; row += step) {
+			for (d = -1; d <= 1; d++) {
+				unsigned word = b * acm->block_len + (row << level) + d;
+				if ((d < 0 && word == 0) || word / chans >= total || n >= max)
+					continue;
+				pos[n++] = word / chans;
+			}
+		}
+	}
+	if (n < max)
+		pos[n++] = total - 1;
+	while (n < max)
+		pos[n++] = gen_rnd(w, total);
+	return n;
+}
+
+/* random seeks with each index mode, returns mismatch count */
+static unsigned check_index(const struct seek_case *sc, int16_t *ref,
+			    unsigned max_bytes)
+{
+	struct gen_writer w, rnd;
+	ACMStream *acm;
+	unsigned total, mode, i, pos, failed = 0;
+	int got, res = 0;
+
+	gen_stream(&w, sc->level, sc->rows, (sc->rows << sc->level) * 37 + 123,
+		   sc->chans, -1);
+	acm = open_gen(&w);
+	total = acm_pcm_total(acm);
+	got = acm_read_loop(acm, ref, max_bytes, 0, 2, 1);
+	res = got - (int)(total * acm_channels(acm) * ACM_WORD);
+	acm_close(acm);
+	if (res != 0) {
+		fprintf(stderr, "level %u: full decode gave %d\n", sc->level, got);
+		free(w.buf);
+		return 1;
+	}
+
+	for (mode = 0; mode < IDX_MODES; mode++) {
+		memset(&rnd, 0, sizeof(rnd));
+		rnd.seed = sc->level * 7 + sc->rows;
+		acm = open_gen(&w);
+		res = 0;
+		if (mode == IDX_LAZY)
+			res = acm_enable_seek_index(acm);
+		else if (mode == IDX_FULL)
+			res = acm_build_seek_index(acm);
+		if (res < 0) {
+			fprintf(stderr, "level %u: index mode %u: %d\n", sc->level, mode, res);
+			failed++;
+		}
+		for (i = 0; i < 200; i++) {
+			/* mostly random, sometimes just past current block */
+			pos = gen_rnd(&rnd, total);
+			if (i % 5 == 4)
+				pos = acm_pcm_tell(acm) + gen_rnd(&rnd, 3 * acm->block_len);
+			if (pos >= total)
+				pos = total - 1;
+			if (check_at(acm, ref, total, pos)) {
+				fprintf(stderr, "level %u rows %u: index mode %u\n",
+					sc->level, sc->rows, mode);
+				failed++;
+				break;
+			}
+		}
+		acm_close(acm);
+	}
+	free(w.buf);
+	return failed;
+}
+
+int main(void)
+{
+	static int16_t ref[2 * 120000];
+	static unsigned pos[400];
+	unsigned c, i, n, failed = 0, seeks = 0;
+
+	for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		const struct seek_case *sc = &cases[c];
+		struct gen_writer w;
+		ACMStream *acm;
+		unsigned total, samples;
+		int got;
+
+		/* values of all channels, a few blocks and a partial one */
+		samples = (sc->rows << sc->level) * 3 + 4321;
+		gen_stream(&w, sc->level, sc->rows, samples, sc->chans, -1);
+
+		/* full decode, data to discard up to each target */
+		acm = open_gen(&w);
+		total = acm_pcm_total(acm);
+		got = acm_read_loop(acm, ref, sizeof(ref), 0, 2, 1);
+		if (got != (int)(total * acm_channels(acm) * ACM_WORD)) {
+			fprintf(stderr, "level %u: full decode gave %d\n", sc->level, got);
+			return 1;
+		}
+		n = make_targets(acm, &w, total, pos, sizeof(pos) / sizeof(pos[0]));
+		acm_close(acm);
+
+		/* fresh stream for each target */
+		for (i = 0; i < n; i += 7) {
+			acm = open_gen(&w);
+			failed += check_at(acm, ref, total, pos[i]);
+			acm_close(acm);
+			seeks++;
+		}
+
+		/* one stream, targets in order made and in random order */
+		acm = open_gen(&w);
+		for (i = 0; i < n; i++)
+			failed += check_at(acm, ref, total, pos[i]);
+		for (i = 0; i < n; i++)
+			failed += check_at(acm, ref, total, pos[gen_rnd(&w, n)]);
+		acm_close(acm);
+		seeks += 2 * n;
+
+		if (failed)
+			fprintf(stderr, "level %u rows %u chans %u: FAILED\n",
+				sc->level, sc->rows, sc->chans);
+		free(w.buf);
+	}
+
+	for (c = 0; c < sizeof(idx_cases) / sizeof(idx_cases[0]); c++) {
+		failed += check_index(&idx_cases[c], ref, sizeof(ref));
+		seeks += IDX_MODES * 200;
+	}
+
+	printf("%u seeks: %s\n", seeks, failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * SIMD kernels against scalar ones, on random data.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Every kernel set that the CPU supports is compared with
+ * acm_scalar_kernels(), output, planar output and juggle results
+ * must match bit for bit.  Exits with 77 (skipped) if there is no
+ * SIMD set to test.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+/* longest run, plus room for misaligned start */
+#define MAX_LEN		1100
+#define MISALIGN	4
+/* block for juggle tests */
+#define JUGGLE_WORDS	(1 << 17)
+
+static const char *set_names[] = { "scalar", "sse2", "avx2", "neon" };
+
+static uint32_t seed = 1;
+
+/* xorshift32 */
+static uint32_t rnd32(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* full range, or 17 + level bits as a block at that level has */
+static void fill_random(int *dst, unsigned n, unsigned level)
+{
+	unsigned i, shift = (rnd32() & 1) ? 15 - level : 0;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (int32_t)rnd32() >> shift;
+}
+
+/* signed values of bits bits */
+static void fill_bits(int *dst, unsigned n, unsigned bits)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (int32_t)rnd32() >> (32 - bits);
+}
+
+/*
+ * Output kernels: all formats, shifts, lengths around vector
+ * width and misaligned src and dst.
+ */
+static unsigned test_out(const ACMStream *ref, const ACMStream *simd)
+{
+	static int src[MAX_LEN + MISALIGN];
+	static unsigned char d1[2 * (MAX_LEN + MISALIGN)], d2[2 * (MAX_LEN + MISALIGN)];
+	static const unsigned long_lens[] = { 63, 64, 65, 255, 1023, 1024, 1025, 1087 };
+	unsigned fmt, level, len, so, dofs, i, failed = 0;
+	unsigned char *e1, *e2;
+
+	for (fmt = 0; fmt < 4; fmt++) {
+		for (level = 0; level < 16; level++) {
+			for (i = 0; i < 40 + sizeof(long_lens) / sizeof(long_lens[0]); i++) {
+				len = i < 40 ? i : long_lens[i - 40];
+				so = rnd32() % MISALIGN;
+				dofs = rnd32() % MISALIGN;
+				fill_random(src, MAX_LEN + MISALIGN, level);
+				memset(d1, 0x5A, sizeof(d1));
+				memset(d2, 0x5A, sizeof(d2));
+				e1 = ref->out_func[fmt](src + so, d1 + dofs, len, level);
+				e2 = simd->out_func[fmt](src + so, d2 + dofs, len, level);
+				if (e1 - d1 != e2 - d2 || memcmp(d1, d2, sizeof(d1)) != 0) {
+					fprintf(stderr, "out_func[%u] level %u len %u src+%u dst+%u: mismatch\n",
+						fmt, level, len, so, dofs);
+					failed++;
+				}
+			}
+		}
+	}
+	return failed;
+}
+
+/*
+ * Planar kernels for 2 planes, from mono and stereo source, against
+ * scalar planar2_* and generic planar_*.  Odd lengths, misaligned
+ * src and frame offset pos into dst, nothing written past n.
+ */
+static unsigned test_planar(const ACMStream *ref, const ACMStream *simd)
+{
+	static const unsigned long_lens[] = { 63, 64, 65, 255, 1023, 1025, 1031 };
+	static int src[2 * MAX_LEN + MISALIGN];
+	static unsigned char p[3][2][4 * (MAX_LEN + MISALIGN)];
+	unsigned sample, step, level, len, so, pos, i, k, failed = 0;
+	void *dst[3][2];
+
+	for (k = 0; k < 3; k++) {
+		dst[k][0] = p[k][0];
+		dst[k][1] = p[k][1];
+	}
+	for (sample = 0; sample < ACM_SAMPLE_COUNT; sample++) {
+		for (step = 1; step <= 2; step++) {
+			for (level = 0; level < 16; level++) {
+				for (i = 0; i < 40 + sizeof(long_lens) / sizeof(long_lens[0]); i++) {
+					len = i < 40 ? i : long_lens[i - 40];
+					so = rnd32() % MISALIGN;
+					pos = rnd32() % MISALIGN;
+					fill_random(src, 2 * MAX_LEN + MISALIGN, level);
+					memset(p, 0x5A, sizeof(p));
+					ref->planar2_func[sample](src + so, step, dst[0], 2, pos, len, level);
+					ref->planar_func[sample](src + so, step, dst[1], 2, pos, len, level);
+					simd->planar2_func[sample](src + so, step, dst[2], 2, pos, len, level);
+					if (memcmp(p[0], p[2], sizeof(p[0])) != 0
+					    || memcmp(p[1], p[2], sizeof(p[1])) != 0) {
+						fprintf(stderr, "planar2_func[%u] step %u level %u len %u src+%u pos %u: mismatch\n",
+							sample, step, level, len, so, pos);
+						failed++;
+					}
+				}
+			}
+		}
+	}
+	return failed;
+}
+
+/*
+ * juggle() on random block and wrapbuf, for every sub_len a block
+ * at levels 1-15 uses, and odd ones around vector widths.
+ */
+static unsigned test_juggle(const ACMStream *ref, const ACMStream *simd)
+{
+	static const unsigned odd_lens[] = { 3, 5, 6, 7, 9, 11, 12, 13, 15, 17, 23, 31 };
+	int *b1, *b2, *w1, *w2;
+	unsigned level, sub_len, sub_count, n, failed = 0;
+
+	b1 = (int *)malloc(JUGGLE_WORDS * sizeof(int));
+	b2 = (int *)malloc(JUGGLE_WORDS * sizeof(int));
+	w1 = (int *)malloc((1 << 16) * sizeof(int));
+	w2 = (int *)malloc((1 << 16) * sizeof(int));
+	if (!b1 || !b2 || !w1 || !w2)
+		exit(1);
+
+	for (level = 1; level < 16 + sizeof(odd_lens) / sizeof(odd_lens[0]); level++) {
+		sub_len = level < 16 ? 1u << (level - 1) : odd_lens[level - 16];
+		for (; sub_len > 0; sub_len /= 2) {
+			sub_count = 2 + 2 * (rnd32() % (JUGGLE_WORDS / sub_len / 2));
+			if (sub_count > 64)
+				sub_count = 2 + 2 * (rnd32() % 32);
+			n = sub_len * sub_count;
+			/* a pass grows values up to 4x, keep it in int */
+			fill_bits(b1, n, 29);
+			fill_bits(w1, 2 * sub_len, 29);
+			memcpy(b2, b1, n * sizeof(int));
+			memcpy(w2, w1, 2 * sub_len * sizeof(int));
+			ref->juggle(w1, b1, sub_len, sub_count);
+			simd->juggle(w2, b2, sub_len, sub_count);
+			if (memcmp(b1, b2, n * sizeof(int)) != 0
+			    || memcmp(w1, w2, 2 * sub_len * sizeof(int)) != 0) {
+				fprintf(stderr, "juggle sub_len %u sub_count %u: mismatch\n",
+					sub_len, sub_count);
+				failed++;
+			}
+			if (level >= 16)
+				break;
+		}
+	}
+
+	/* whole blocks through juggle_block, all passes of each level */
+	for (level = 1; level < 16; level++) {
+		ACMStream a = *ref, b = *simd;
+		unsigned rows = 1 + rnd32() % (JUGGLE_WORDS >> level);
+		if (rows > 40)
+			rows = 1 + rnd32() % 40;
+		a.info.acm_level = b.info.acm_level = level;
+		acm_scalar_kernels(&a);
+		a.juggle_block = b.juggle_block = a.juggle_block;
+		n = rows << level;
+		a.block = b1;
+		b.block = b2;
+		a.wrapbuf = w1;
+		b.wrapbuf = w2;
+		fill_bits(b1, n, level < 14 ? 29 - 2 * level : 2);
+		fill_bits(w1, 2 << level, level < 14 ? 29 - 2 * level : 2);
+		memcpy(b2, b1, n * sizeof(int));
+		memcpy(w2, w1, (2 << level) * sizeof(int));
+		a.juggle_block(&a, 0, rows);
+		b.juggle_block(&b, 0, rows);
+		if (memcmp(b1, b2, n * sizeof(int)) != 0
+		    || memcmp(w1, w2, (2 << level) * sizeof(int)) != 0) {
+			fprintf(stderr, "juggle_block level %u rows %u: mismatch\n",
+				level, rows);
+			failed++;
+		}
+	}
+
+	free(b1);
+	free(b2);
+	free(w1);
+	free(w2);
+	return failed;
+}
+
+int main(void)
+{
+	ACMStream *ref, *simd;
+	unsigned set, tested = 0, failed = 0, f;
+
+	ref = (ACMStream *)calloc(1, sizeof(ACMStream));
+	simd = (ACMStream *)calloc(1, sizeof(ACMStream));
+	if (!ref || !simd)
+		return 1;
+	acm_scalar_kernels(ref);
+
+	for (set = ACM_SIMD_SSE2; set <= ACM_SIMD_NEON; set++) {
+		*simd = *ref;
+		if (acm_simd_use(simd, set) < 0)
+			continue;
+		tested++;
+		f = test_out(ref, simd);
+		f += test_planar(ref, simd);
+		f += test_juggle(ref, simd);
+		printf("%s: %s\n", set_names[set], f ? "FAILED" : "ok");
+		failed += f;
+	}
+
+	free(ref);
+	free(simd);
+	if (!tested) {
+		printf("no SIMD kernels on this CPU\n");
+		return 77;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * Reentrancy test: decode many streams at once from several
+ * threads and compare with single-threaded decode.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Streams are generated, with levels, fillers and channel counts
+ * mixed.  Each thread decodes all of them in its own order, odd
+ * threads through io callbacks so load_buf() runs too.  Then each
+ * stream goes through acm_decode_all_parallel(), with a counting
+ * allocator that its private streams must use too.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+#include "streamgen.h"
+
+#define NSTREAMS	8
+#define NTHREADS	8
+#define ROUNDS		16
+
+struct stream {
+	struct gen_writer w;
+	unsigned char *ref;
+	int ref_len;
+	unsigned out_max;
+};
+
+struct worker {
+	unsigned id;
+	acm_thread *thread;
+	unsigned char *out;
+	unsigned failed;
+};
+
+static struct stream streams[NSTREAMS];
+static unsigned out_max;
+
+struct mem_file {
+	const struct gen_writer *w;
+	unsigned pos;
+};
+
+static int mem_read(void *dst, int size, int n, void *arg)
+{
+	struct mem_file *f = (struct mem_file *)arg;
+	unsigned len = size * n;
+	if (len > f->w->len - f->pos)
+		len = f->w->len - f->pos;
+	memcpy(dst, f->w->buf + f->pos, len);
+	f->pos += len;
+	return len;
+}
+
+static int mem_length(void *arg)
+{
+	return ((struct mem_file *)arg)->w->len;
+}
+
+/* whole stream to 16-bit LE, returns bytes or error */
+static int decode(const struct stream *s, unsigned char *dst, int use_io)
+{
+	static const acm_io_callbacks cb = {
+		mem_read, NULL, NULL, mem_length
+	};
+	struct mem_file f;
+	ACMStream *acm;
+	int err, got;
+
+	f.w = &s->w;
+	f.pos = 0;
+	if (use_io)
+		err = acm_open_decoder(&acm, &f, cb, 0);
+	else
+		err = acm_open_memory(&acm, s->w.buf, s->w.len, 0);
+	if (err < 0)
+		return err;
+	got = acm_read_loop(acm, dst, s->out_max, 0, 2, 1);
+	acm_close(acm);
+	return got;
+}
+
+struct counted {
+	acm_mutex *lock;
+	unsigned allocs, frees;
+};
+
+static void *count_alloc(size_t size, void *arg)
+{
+	struct counted *c = (struct counted *)arg;
+
+	acm_mutex_lock(c->lock);
+	c->allocs++;
+	acm_mutex_unlock(c->lock);
+	return malloc(size);
+}
+
+static void count_free(void *ptr, void *arg)
+{
+	struct counted *c = (struct counted *)arg;
+
+	acm_mutex_lock(c->lock);
+	c->frees++;
+	acm_mutex_unlock(c->lock);
+	free(ptr);
+}
+
+/* returns mismatch count */
+static unsigned check_parallel(const struct stream *s, unsigned char *dst,
+			       unsigned nthreads)
+{
+	struct counted c;
+	ACMOptions opts;
+	ACMStream *acm;
+	unsigned allocs, failed = 0;
+	int got;
+
+	memset(&opts, 0, sizeof(opts));
+	c.lock = acm_mutex_new();
+	c.allocs = c.frees = 0;
+	opts.alloc_func = count_alloc;
+	opts.free_func = count_free;
+	opts.alloc_arg = &c;
+	if (!c.lock || acm_open_memory_ex(&acm, s->w.buf, s->w.len, 0, &opts) < 0)
+		return 1;
+	allocs = c.allocs;
+	got = acm_decode_all_parallel(acm, dst, nthreads);
+	if (got != s->ref_len || memcmp(dst, s->ref, got) != 0)
+		failed++;
+	/* private streams took at least stream and buffers each */
+	if (nthreads > 1 && c.allocs < allocs + 2 * nthreads)
+		failed++;
+	acm_close(acm);
+	if (c.allocs != c.frees)
+		failed++;
+	acm_mutex_free(c.lock);
+	return failed;
+}
+
+static void worker_main(void *arg)
+{
+	struct worker *wk = (struct worker *)arg;
+	unsigned r, i;
+	int got;
+
+	for (r = 0; r < ROUNDS; r++) {
+		for (i = 0; i < NSTREAMS; i++) {
+			const struct stream *s = &streams[(i + wk->id + r) % NSTREAMS];
+			got = decode(s, wk->out, wk->id & 1);
+			if (got != s->ref_len || memcmp(wk->out, s->ref, got) != 0)
+				wk->failed++;
+		}
+	}
+}
+
+int main(void)
+{
+	static const unsigned levels[NSTREAMS] = { 0, 2, 3, 5, 7, 8, 10, 12 };
+	struct worker workers[NTHREADS];
+	unsigned i, failed = 0;
+	unsigned char *ref;
+
+	for (i = 0; i < NSTREAMS; i++) {
+		struct stream *s = &streams[i];
+		unsigned level = levels[i], rows = 2048 >> (level / 2);
+		unsigned samples = 100000 + i * 7919;
+
+		gen_stream(&s->w, level, rows, samples, 1 + (i & 1),
+			   i == 3 ? 19 : -1);
+		/* room for a padded last frame */
+		s->out_max = (samples + 2) * ACM_WORD;
+		if (s->out_max > out_max)
+			out_max = s->out_max;
+		s->ref = (unsigned char *)malloc(s->out_max);
+		if (!s->ref)
+			return 1;
+		s->ref_len = decode(s, s->ref, 0);
+		if (s->ref_len <= 0) {
+			fprintf(stderr, "stream %u: decode failed: %d\n", i, s->ref_len);
+			return 1;
+		}
+	}
+
+	for (i = 0; i < NTHREADS; i++) {
+		workers[i].id = i;
+		workers[i].failed = 0;
+		workers[i].out = (unsigned char *)malloc(out_max);
+		if (!workers[i].out)
+			return 1;
+		workers[i].thread = acm_thread_start(worker_main, &workers[i]);
+		if (!workers[i].thread) {
+			fprintf(stderr, "cannot start thread\n");
+			return 1;
+		}
+	}
+	for (i = 0; i < NTHREADS; i++) {
+		acm_thread_join(workers[i].thread);
+		if (workers[i].failed)
+			fprintf(stderr, "thread %u: %u mismatches\n", i, workers[i].failed);
+		failed += workers[i].failed;
+		free(workers[i].out);
+	}
+
+	ref = (unsigned char *)malloc(out_max);
+	if (!ref)
+		return 1;
+	for (i = 0; i < NSTREAMS; i++) {
+		unsigned n = check_parallel(&streams[i], ref, 1 + i % 4);
+		if (n)
+			fprintf(stderr, "stream %u: parallel decode failed\n", i);
+		failed += n;
+	}
+	free(ref);
+	for (i = 0; i < NSTREAMS; i++) {
+		free(streams[i].ref);
+		free(streams[i].w.buf);
+	}
+
+	printf("%u threads, %u decodes: %s\n", NTHREADS,
+	       NTHREADS * ROUNDS * NSTREAMS, failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
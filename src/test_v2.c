@@ -0,0 +1,259 @@
+/*
+ * v2 I/O callbacks against memory decode.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Two generated streams are put into an archive that read_at()
+ * places past 4G, with junk around them, and read_at() gives short
+ * reads.  Streams are opened with explicit window and with len 0
+ * through get_length_func, read interleaved from one datasrc and
+ * seeked.  acm_open_fd() is checked on a real file.  Output must
+ * be same as from acm_open_memory().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#include "libacm.h"
+#include "streamgen.h"
+
+#ifndef O_BINARY
+#define O_BINARY	0
+#endif
+
+/* archive starts here in source offsets */
+#define ARC_BASE	((uint64_t)5 << 30)
+#define JUNK		1234
+#define OUT_MAX		(2 * 80000)
+
+struct archive {
+	unsigned char *buf;
+	size_t len;
+	struct gen_writer rnd;		/* short read sizes */
+	unsigned reads, closes;
+	int bad_ofs;			/* read below ARC_BASE */
+};
+
+static unsigned failed;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "line %d: %s\n", __LINE__, #cond); \
+		failed++; \
+	} \
+} while (0)
+
+static int arc_read_at(void *arg, void *dst, unsigned len, uint64_t ofs)
+{
+	struct archive *a = (struct archive *)arg;
+	uint64_t left;
+
+	a->reads++;
+	if (ofs < ARC_BASE) {
+		a->bad_ofs = 1;
+		return -1;
+	}
+	ofs -= ARC_BASE;
+	if (ofs >= a->len)
+		return 0;
+	left = a->len - ofs;
+	/* short read, but never 0 before end */
+	len = 1 + gen_rnd(&a->rnd, len);
+	if (len > left)
+		len = (unsigned)left;
+	memcpy(dst, a->buf + ofs, len);
+	return len;
+}
+
+static int arc_close(void *arg)
+{
+	((struct archive *)arg)->closes++;
+	return 0;
+}
+
+static int64_t arc_length(void *arg)
+{
+	return ARC_BASE + ((struct archive *)arg)->len;
+}
+
+static const acm_io_callbacks_v2 arc_io = {
+	arc_read_at, arc_close, arc_length
+};
+
+/* whole output of acm */
+static int read_all(ACMStream *acm, int16_t *out)
+{
+	return acm_read_loop(acm, out, OUT_MAX * ACM_WORD, 0, 2, 1);
+}
+
+static int write_file(const char *fn, const void *data, size_t len)
+{
+	FILE *f = fopen(fn, "wb");
+	size_t n;
+
+	if (!f)
+		return -1;
+	n = fwrite(data, 1, len, f);
+	if (fclose(f) != 0 || n != len)
+		return -1;
+	return 0;
+}
+
+int main(void)
+{
+	static int16_t ref[2][OUT_MAX], out[2][OUT_MAX];
+	static const char *fn = "test_v2.bin";
+	struct gen_writer w[2];
+	struct archive arc;
+	uint64_t ofs[2];
+	ACMStream *acm, *s[2];
+	int ref_len[2], got[2], res, i, done, fd;
+	unsigned pos;
+
+	/* junk, stream 0, junk, stream 1, junk */
+	gen_stream(&w[0], 7, 30, 100000, 2, -1);
+	gen_stream(&w[1], 3, 200, 70001, 1, -1);
+	memset(&arc, 0, sizeof(arc));
+	arc.len = 3 * JUNK + w[0].len + w[1].len;
+	arc.buf = (unsigned char *)malloc(arc.len);
+	if (!arc.buf)
+		return 1;
+	for (i = 0; i < (int)arc.len; i++)
+		arc.buf[i] = (unsigned char)(i * 37 + 11);
+	ofs[0] = JUNK;
+	ofs[1] = 2 * JUNK + w[0].len;
+	for (i = 0; i < 2; i++) {
+		memcpy(arc.buf + ofs[i], w[i].buf, w[i].len);
+		if (acm_open_memory(&acm, w[i].buf, w[i].len, 0) < 0)
+			return 1;
+		ref_len[i] = read_all(acm, ref[i]);
+		acm_close(acm);
+		CHECK(ref_len[i] > 0);
+	}
+	arc.rnd.seed = 7;
+
+	/* explicit window, junk after it is not read as stream */
+	for (i = 0; i < 2; i++) {
+		res = acm_open_decoder_v2(&acm, &arc, &arc_io, ARC_BASE + ofs[i],
+					  w[i].len, 0, NULL);
+		CHECK(res == 0);
+		if (res < 0)
+			continue;
+		got[i] = read_all(acm, out[i]);
+		CHECK(got[i] == ref_len[i] && memcmp(out[i], ref[i], got[i]) == 0);
+		CHECK(acm_reset(acm, &arc) == ACM_ERR_OTHER);
+		acm_close(acm);
+	}
+	CHECK(arc.closes == 2 && !arc.bad_ofs);
+
+	/* len 0 reads up to end of source */
+	res = acm_open_decoder_v2(&acm, &arc, &arc_io, ARC_BASE + ofs[1], 0, 0, NULL);
+	CHECK(res == 0);
+	if (res == 0) {
+		got[1] = read_all(acm, out[1]);
+		CHECK(got[1] == ref_len[1] && memcmp(out[1], ref[1], got[1]) == 0);
+		acm_close(acm);
+	}
+	res = acm_open_decoder_v2(&acm, &arc, &arc_io, ARC_BASE + arc.len, 0, 0, NULL);
+	CHECK(res == ACM_ERR_NOT_ACM);
+
+	/* both streams from one datasrc, small reads in turn */
+	for (i = 0; i < 2; i++) {
+		res = acm_open_decoder_v2(&s[i], &arc, &arc_io, ARC_BASE + ofs[i],
+					  w[i].len, 0, NULL);
+		CHECK(res == 0);
+		if (res < 0)
+			return 1;
+		got[i] = 0;
+	}
+	do {
+		done = 1;
+		for (i = 0; i < 2; i++) {
+			res = acm_read_loop(s[i], (unsigned char *)out[i] + got[i],
+					    1000, 0, 2, 1);
+			if (res > 0) {
+				got[i] += res;
+				done = 0;
+			}
+		}
+	} while (!done);
+	for (i = 0; i < 2; i++)
+		CHECK(got[i] == ref_len[i] && memcmp(out[i], ref[i], got[i]) == 0);
+
+	/* seeks back and forth, with and without index */
+	CHECK(acm_build_seek_index(s[0]) == 0);
+	for (i = 0; i < 200; i++) {
+		struct gen_writer *r = &arc.rnd;
+		ACMStream *a = s[i & 1];
+		unsigned chans = acm_channels(a);
+		unsigned total = acm_pcm_total(a);
+
+		pos = gen_rnd(r, total - 100);
+		res = acm_seek_pcm(a, pos);
+		CHECK(res == (int)pos);
+		res = acm_read_loop(a, out[0], 100 * chans * ACM_WORD, 0, 2, 1);
+		CHECK(res == (int)(100 * chans * ACM_WORD)
+		      && memcmp(out[0], ref[i & 1] + pos * chans, res) == 0);
+	}
+	acm_close(s[0]);
+	acm_close(s[1]);
+	CHECK(!arc.bad_ofs);
+
+	/* acm_open_fd() on a file, stream 1 in the middle */
+	if (write_file(fn, arc.buf, arc.len) < 0) {
+		fprintf(stderr, "%s: cannot write\n", fn);
+		return 1;
+	}
+	fd = open(fn, O_RDONLY | O_BINARY);
+	CHECK(fd >= 0);
+	if (fd >= 0) {
+		res = acm_open_fd(&acm, fd, ofs[1], w[1].len, 0);
+		CHECK(res == 0);
+		if (res == 0) {
+			got[1] = read_all(acm, out[1]);
+			CHECK(got[1] == ref_len[1] && memcmp(out[1], ref[1], got[1]) == 0);
+			acm_close(acm);
+		}
+		res = acm_open_fd(&acm, fd, ofs[0], 0, 0);
+		CHECK(res == 0);
+		if (res == 0) {
+			got[0] = read_all(acm, out[0]);
+			CHECK(got[0] == ref_len[0] && memcmp(out[0], ref[0], got[0]) == 0);
+			acm_close(acm);
+		}
+		close(fd);
+	}
+	remove(fn);
+
+	free(arc.buf);
+	free(w[0].buf);
+	free(w[1].buf);
+	printf("v2 callbacks: %s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
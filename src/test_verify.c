@@ -0,0 +1,216 @@
+/*
+ * acm_verify() on damaged streams.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * A generated stream is checked whole, truncated, and with the
+ * first column of a block given a reserved filler index.  Samples
+ * reported as valid must be what acm_read_loop() really gives.
+ * Block headers with amplitude table power too small for their
+ * values are not damage, those decode same as with full power.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libacm.h"
+#include "acm_internal.h"
+#include "streamgen.h"
+
+#define LEVEL		5
+#define ROWS		32
+#define SAMPLES		40000
+#define BAD_FILLER	1		/* f_bad in decode.c */
+
+static unsigned failed;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "line %d: %s\n", __LINE__, #cond); \
+		failed++; \
+	} \
+} while (0)
+
+static ACMStream *open_buf(const unsigned char *buf, size_t len)
+{
+	ACMStream *acm;
+	int err = acm_open_memory(&acm, buf, len, 0);
+	if (err < 0) {
+		fprintf(stderr, "cannot open stream: %d\n", err);
+		exit(1);
+	}
+	return acm;
+}
+
+/* frames a plain read gives */
+static unsigned decoded_frames(const unsigned char *buf, size_t len)
+{
+	static int16_t out[SAMPLES + 2];
+	ACMStream *acm = open_buf(buf, len);
+	int got;
+
+	got = acm_read_loop(acm, out, sizeof(out), 0, 2, 1);
+	got = got > 0 ? got / (acm_channels(acm) * ACM_WORD) : 0;
+	acm_close(acm);
+	return got;
+}
+
+/* bit offset of each block start, returns block count */
+static unsigned block_bits(const unsigned char *buf, size_t len,
+			   uint64_t *bits, unsigned max)
+{
+	ACMStream *acm = open_buf(buf, len);
+	ACMSeekPoint sp;
+	unsigned n = 0;
+
+	while (n < max) {
+		acm_save_seek_point(acm, &sp);
+		if (acm_skip_block(acm) <= 0)
+			break;
+		bits[n++] = (uint64_t)sp.raw_ofs * 8 - sp.bit_avail;
+	}
+	acm_close(acm);
+	return n;
+}
+
+/* first filler index of block is 5 bits after 20 bits of header */
+static void corrupt_block(unsigned char *buf, uint64_t start)
+{
+	uint64_t pos = start + 20;
+	unsigned i;
+
+	for (i = 0; i < 5; i++, pos++) {
+		if ((BAD_FILLER >> i) & 1)
+			buf[pos / 8] |= 1 << (pos % 8);
+		else
+			buf[pos / 8] &= ~(1 << (pos % 8));
+	}
+}
+
+/* 4-bit amplitude table power at block start */
+static void set_pwr(unsigned char *buf, uint64_t start, unsigned pwr)
+{
+	uint64_t pos = start;
+	unsigned i;
+
+	for (i = 0; i < 4; i++, pos++) {
+		if ((pwr >> i) & 1)
+			buf[pos / 8] |= 1 << (pos % 8);
+		else
+			buf[pos / 8] &= ~(1 << (pos % 8));
+	}
+}
+
+/* 1 if both decode to same data */
+static int same_output(const unsigned char *a, const unsigned char *b, size_t len)
+{
+	static int16_t out_a[SAMPLES + 2], out_b[SAMPLES + 2];
+	ACMStream *acm;
+	int got_a, got_b;
+
+	acm = open_buf(a, len);
+	got_a = acm_read_loop(acm, out_a, sizeof(out_a), 0, 2, 1);
+	acm_close(acm);
+	acm = open_buf(b, len);
+	got_b = acm_read_loop(acm, out_b, sizeof(out_b), 0, 2, 1);
+	acm_close(acm);
+	return got_a > 0 && got_a == got_b && memcmp(out_a, out_b, got_a) == 0;
+}
+
+static int verify(const unsigned char *buf, size_t len, ACMVerifyReport *rep)
+{
+	ACMStream *acm = open_buf(buf, len);
+	int err = acm_verify(acm, rep);
+	acm_close(acm);
+	return err;
+}
+
+int main(void)
+{
+	static uint64_t bits[1000];
+	ACMVerifyReport rep;
+	struct gen_writer w;
+	unsigned char *bad;
+	unsigned nblocks, frames, block_frames, i;
+	int err;
+
+	gen_stream(&w, LEVEL, ROWS, SAMPLES, 2, -1);
+	nblocks = block_bits(w.buf, w.len, bits, 1000);
+	frames = decoded_frames(w.buf, w.len);
+	block_frames = (ROWS << LEVEL) / 2;
+	bad = (unsigned char *)malloc(w.len);
+	if (!bad)
+		return 1;
+
+	/* whole stream */
+	err = verify(w.buf, w.len, &rep);
+	CHECK(err == 0);
+	CHECK(rep.blocks == nblocks && rep.bad_blocks == 0);
+	CHECK(rep.pcm_valid == rep.pcm_header && rep.pcm_valid == frames);
+
+	/* truncated */
+	err = verify(w.buf, w.len * 3 / 5, &rep);
+	CHECK(err == ACM_ERR_UNEXPECTED_EOF);
+	CHECK(rep.bad_blocks == 0 && rep.blocks < nblocks);
+	CHECK(rep.pcm_valid == decoded_frames(w.buf, w.len * 3 / 5));
+	CHECK(rep.pcm_valid == rep.blocks * block_frames);
+
+	/* bad block in the middle, parsing goes on after it */
+	memcpy(bad, w.buf, w.len);
+	corrupt_block(bad, bits[7]);
+	err = verify(bad, w.len, &rep);
+	CHECK(err == ACM_ERR_CORRUPT);
+	CHECK(rep.bad_blocks >= 1 && rep.first_bad == 7 && rep.last_bad >= 7);
+	CHECK(rep.pcm_valid == 7 * block_frames);
+	CHECK(rep.pcm_valid == decoded_frames(bad, w.len));
+
+	/* bad last block */
+	memcpy(bad, w.buf, w.len);
+	corrupt_block(bad, bits[nblocks - 1]);
+	err = verify(bad, w.len, &rep);
+	CHECK(err == ACM_ERR_CORRUPT);
+	CHECK(rep.bad_blocks == 1 && rep.blocks == nblocks - 1);
+	CHECK(rep.first_bad == nblocks - 1 && rep.last_bad == nblocks - 1);
+	CHECK(rep.pcm_valid == (nblocks - 1) * block_frames);
+	CHECK(rep.pcm_valid == decoded_frames(bad, w.len));
+
+	/* bad block and truncation */
+	memcpy(bad, w.buf, w.len);
+	corrupt_block(bad, bits[2]);
+	err = verify(bad, w.len / 2, &rep);
+	CHECK(err == ACM_ERR_CORRUPT);
+	CHECK(rep.first_bad == 2 && rep.pcm_valid == 2 * block_frames);
+
+	/* pwr too small for filler values */
+	memcpy(bad, w.buf, w.len);
+	for (i = 0; i < nblocks; i++)
+		set_pwr(bad, bits[i], i % 3);
+	CHECK(same_output(w.buf, bad, w.len));
+	err = verify(bad, w.len, &rep);
+	CHECK(err == 0 && rep.bad_blocks == 0);
+
+	free(bad);
+	free(w.buf);
+
+	printf("verify: %s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * Thread wrappers for libacm.
+ *
+ * Copyright (c) 2026, libacm authors
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Minimal pthread / Win32 layer, handles are opaque
+ * so that libacm.h does not need system headers.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+/* condition variables need Vista */
+#if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "libacm.h"
+#include "acm_internal.h"
+
+struct acm_thread {
+	void (*func)(void *arg);
+	void *arg;
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t tid;
+#endif
+};
+
+struct acm_mutex {
+#ifdef _WIN32
+	CRITICAL_SECTION cs;
+#else
+	pthread_mutex_t mutex;
+#endif
+};
+
+struct acm_cond {
+#ifdef _WIN32
+	CONDITION_VARIABLE cv;
+#else
+	pthread_cond_t cond;
+#endif
+};
+
+#ifdef _WIN32
+
+static DWORD WINAPI thread_main(LPVOID arg)
+{
+	acm_thread *t = (acm_thread *)arg;
+	t->func(t->arg);
+	return 0;
+}
+
+acm_thread *acm_thread_start(void (*func)(void *arg), void *arg)
+{
+	acm_thread *t = (acm_thread *)malloc(sizeof(*t));
+	if (!t)
+		return NULL;
+	t->func = func;
+	t->arg = arg;
+	t->handle = CreateThread(NULL, 0, thread_main, t, 0, NULL);
+	if (t->handle == NULL) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+void acm_thread_join(acm_thread *t)
+{
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+	free(t);
+}
+
+acm_mutex *acm_mutex_new(void)
+{
+	acm_mutex *m = (acm_mutex *)malloc(sizeof(*m));
+	if (m)
+		InitializeCriticalSection(&m->cs);
+	return m;
+}
+
+void acm_mutex_free(acm_mutex *m)
+{
+	DeleteCriticalSection(&m->cs);
+	free(m);
+}
+
+void acm_mutex_lock(acm_mutex *m)
+{
+	EnterCriticalSection(&m->cs);
+}
+
+void acm_mutex_unlock(acm_mutex *m)
+{
+	LeaveCriticalSection(&m->cs);
+}
+
+acm_cond *acm_cond_new(void)
+{
+	acm_cond *c = (acm_cond *)malloc(sizeof(*c));
+	if (c)
+		InitializeConditionVariable(&c->cv);
+	return c;
+}
+
+void acm_cond_free(acm_cond *c)
+{
+	free(c);
+}
+
+void acm_cond_wait(acm_cond *c, acm_mutex *m)
+{
+	SleepConditionVariableCS(&c->cv, &m->cs, INFINITE);
+}
+
+void acm_cond_broadcast(acm_cond *c)
+{
+	WakeAllConditionVariable(&c->cv);
+}
+
+/* SRWLOCK, unlike CRITICAL_SECTION, has static init */
+static SRWLOCK once_lock = SRWLOCK_INIT;
+
+void acm_once(int *done, void (*func)(void))
+{
+	AcquireSRWLockExclusive(&once_lock);
+	if (!*done) {
+		func();
+		*done = 1;
+	}
+	ReleaseSRWLockExclusive(&once_lock);
+}
+
+unsigned acm_cpu_count(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return si.dwNumberOfProcessors > 0 ? si.dwNumberOfProcessors : 1;
+}
+
+#else /* !_WIN32 */
+
+static void *thread_main(void *arg)
+{
+	acm_thread *t = (acm_thread *)arg;
+	t->func(t->arg);
+	return NULL;
+}
+
+acm_thread *acm_thread_start(void (*func)(void *arg), void *arg)
+{
+	acm_thread *t = (acm_thread *)malloc(sizeof(*t));
+	if (!t)
+		return NULL;
+	t->func = func;
+	t->arg = arg;
+	if (pthread_create(&t->tid, NULL, thread_main, t) != 0) {
+		free(t);
+		return NULL;
+	}
+	return t;
+}
+
+void acm_thread_join(acm_thread *t)
+{
+	pthread_join(t->tid, NULL);
+	free(t);
+}
+
+acm_mutex *acm_mutex_new(void)
+{
+	acm_mutex *m = (acm_mutex *)malloc(sizeof(*m));
+	if (m && pthread_mutex_init(&m->mutex, NULL) != 0) {
+		free(m);
+		return NULL;
+	}
+	return m;
+}
+
+void acm_mutex_free(acm_mutex *m)
+{
+	pthread_mutex_destroy(&m->mutex);
+	free(m);
+}
+
+void acm_mutex_lock(acm_mutex *m)
+{
+	pthread_mutex_lock(&m->mutex);
+}
+
+void acm_mutex_unlock(acm_mutex *m)
+{
+	pthread_mutex_unlock(&m->mutex);
+}
+
+acm_cond *acm_cond_new(void)
+{
+	acm_cond *c = (acm_cond *)malloc(sizeof(*c));
+	if (c && pthread_cond_init(&c->cond, NULL) != 0) {
+		free(c);
+		return NULL;
+	}
+	return c;
+}
+
+void acm_cond_free(acm_cond *c)
+{
+	pthread_cond_destroy(&c->cond);
+	free(c);
+}
+
+void acm_cond_wait(acm_cond *c, acm_mutex *m)
+{
+	pthread_cond_wait(&c->cond, &m->mutex);
+}
+
+void acm_cond_broadcast(acm_cond *c)
+{
+	pthread_cond_broadcast(&c->cond);
+}
+
+static pthread_mutex_t once_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void acm_once(int *done, void (*func)(void))
+{
+	pthread_mutex_lock(&once_lock);
+	if (!*done) {
+		func();
+		*done = 1;
+	}
+	pthread_mutex_unlock(&once_lock);
+}
+
+unsigned acm_cpu_count(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > 0)
+		return n;
+#endif
+	return 1;
+}
+
+#endif /* !_WIN32 */
@@ -21,11 +21,34 @@
 #include "config.h"
 #endif
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+/* no mmap, acm_open_mmap() reads whole file */
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef ACM_STATS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
 #include "libacm.h"
+#include "acm_internal.h"
 
 #define WAVC_HEADER_LEN	28
 #define ACM_HEADER_LEN	14
@@ -86,6 +109,209 @@ int acm_open_file(ACMStream **res, const char *filename, int force_chans)
 	return 0;
 }
 
+/*
+ * acm_probe() on first bytes of file.  raw_len, if not NULL,
+ * gets file size, for acm_probe_bitrate().
+ */
+int acm_probe_file(const char *filename, ACMInfo *out, unsigned *total_values,
+		   unsigned *raw_len)
+{
+	unsigned char hdr[ACM_HEADER_LEN + WAVC_HEADER_LEN];
+	size_t got;
+	int len = 0;
+	FILE *f;
+
+	if ((f = fopen(filename, "rb")) == NULL)
+		return ACM_ERR_OPEN;
+	got = fread(hdr, 1, sizeof(hdr), f);
+	if (raw_len)
+		len = _get_length_file(f);
+	fclose(f);
+
+	if (raw_len)
+		*raw_len = len > 0 ? len : 0;
+	return acm_probe(hdr, got, out, total_values);
+}
+
+/* Whole file in memory */
+struct acm_mapping {
+	void *base;
+	size_t len;
+};
+
+static int _unmap_file(void *arg) {
+	struct acm_mapping *m = (struct acm_mapping *)arg;
+#ifdef _WIN32
+	free(m->base);
+#else
+	munmap(m->base, m->len);
+#endif
+	free(m);
+	return 0;
+}
+
+#ifdef _WIN32
+static int map_file(struct acm_mapping *m, const char *filename)
+{
+	FILE *f;
+	long len;
+
+	if ((f = fopen(filename, "rb")) == NULL)
+		return ACM_ERR_OPEN;
+	if (fseek(f, 0, SEEK_END) < 0 || (len = ftell(f)) < 0) {
+		fclose(f);
+		return ACM_ERR_READ_ERR;
+	}
+	if (len == 0) {
+		fclose(f);
+		return ACM_ERR_NOT_ACM;
+	}
+	rewind(f);
+	m->len = len;
+	m->base = malloc(m->len);
+	if (!m->base) {
+		fclose(f);
+		return ACM_ERR_OTHER;
+	}
+	if (fread(m->base, 1, m->len, f) != m->len) {
+		free(m->base);
+		fclose(f);
+		return ACM_ERR_READ_ERR;
+	}
+	fclose(f);
+	return 0;
+}
+#else
+static int map_file(struct acm_mapping *m, const char *filename)
+{
+	struct stat st;
+	int fd;
+
+	if ((fd = open(filename, O_RDONLY)) < 0)
+		return ACM_ERR_OPEN;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return ACM_ERR_READ_ERR;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return ACM_ERR_NOT_ACM;
+	}
+	m->len = st.st_size;
+	m->base = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (m->base == MAP_FAILED)
+		return ACM_ERR_READ_ERR;
+	return 0;
+}
+#endif
+
+/*
+ * Like acm_open_file(), but decoder reads straight from
+ * mapped file, there is no read buffer.
+ */
+int acm_open_mmap(ACMStream **res, const char *filename, int force_chans)
+{
+	int err;
+	struct acm_mapping *m;
+	ACMStream *acm;
+
+	m = (struct acm_mapping *)malloc(sizeof(*m));
+	if (!m)
+		return ACM_ERR_OTHER;
+	if ((err = map_file(m, filename)) < 0) {
+		free(m);
+		return err;
+	}
+	if ((err = acm_open_memory(&acm, m->base, m->len, force_chans)) < 0) {
+		_unmap_file(m);
+		return err;
+	}
+	acm->io.close_func = _unmap_file;
+	acm->io_arg = m;
+	*res = acm;
+	return 0;
+}
+
+/*
+ * Positional reads from descriptor.  Windows has no pread(),
+ * ReadFile() with offset there also moves the file pointer.
+ */
+#ifdef _WIN32
+static int _read_fd(void *arg, void *dst, unsigned len, uint64_t ofs)
+{
+	HANDLE h = (HANDLE)_get_osfhandle(*(int *)arg);
+	OVERLAPPED ov;
+	DWORD got;
+
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = (DWORD)ofs;
+	ov.OffsetHigh = (DWORD)(ofs >> 32);
+	if (!ReadFile(h, dst, len, &got, &ov))
+		return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+	return got;
+}
+
+static int64_t _get_length_fd(void *arg)
+{
+	HANDLE h = (HANDLE)_get_osfhandle(*(int *)arg);
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(h, &size))
+		return -1;
+	return size.QuadPart;
+}
+#else
+static int _read_fd(void *arg, void *dst, unsigned len, uint64_t ofs)
+{
+	ssize_t res;
+
+	do {
+		res = pread(*(int *)arg, dst, len, (off_t)ofs);
+	} while (res < 0 && errno == EINTR);
+	return res;
+}
+
+static int64_t _get_length_fd(void *arg)
+{
+	struct stat st;
+
+	if (fstat(*(int *)arg, &st) < 0)
+		return -1;
+	return st.st_size;
+}
+#endif
+
+static int _free_fd(void *arg)
+{
+	free(arg);
+	return 0;
+}
+
+/*
+ * Decode stream at base of open file, eg. inside an archive.
+ * len 0 means up to end of file.  fd is not closed, nor moved
+ * except on Windows, any number of streams may read the same fd
+ * at once.
+ */
+int acm_open_fd(ACMStream **res, int fd, uint64_t base, uint64_t len, int force_chans)
+{
+	acm_io_callbacks_v2 io;
+	int *arg, err;
+
+	if ((arg = (int *)malloc(sizeof(*arg))) == NULL)
+		return ACM_ERR_OTHER;
+	*arg = fd;
+
+	memset(&io, 0, sizeof(io));
+	io.read_at = _read_fd;
+	io.close_func = _free_fd;
+	io.get_length_func = _get_length_fd;
+	if ((err = acm_open_decoder_v2(res, arg, &io, base, len, force_chans, NULL)) < 0)
+		free(arg);
+	return err;
+}
+
 /* utility functions */
 
 static uint32_t pcm2time(ACMStream *acm, uint64_t pcm)
@@ -125,15 +351,27 @@ int acm_seekable(ACMStream *acm)
 }
 
 uint32_t acm_bitrate(ACMStream *acm)
+{
+	return acm_probe_bitrate(&acm->info, acm->total_values, acm_raw_total(acm));
+}
+
+/* same as acm_time_total(), for acm_probe() results */
+unsigned acm_probe_time(const ACMInfo *inf, unsigned total_values)
+{
+	return (uint64_t)(total_values / inf->channels) * 1000 / inf->rate;
+}
+
+/* same as acm_bitrate(), raw_len is file size */
+unsigned acm_probe_bitrate(const ACMInfo *inf, unsigned total_values, unsigned raw_len)
 {
 	uint64_t bits, time, bitrate = 0;
 
-	if (acm_raw_total(acm) == 0)
+	if (raw_len == 0)
 		return 13000;
 
-	time = acm_time_total(acm);
+	time = acm_probe_time(inf, total_values);
 	if (time > 0) {
-		bits = 8 * acm_raw_total(acm);
+		bits = 8 * (uint64_t)raw_len;
 		bitrate = 1000 * bits / time;
 	}
 	return bitrate;
@@ -169,6 +407,54 @@ unsigned acm_raw_total(ACMStream *acm)
 	return acm->data_len;
 }
 
+/* bytes allocated for the stream, mapped or caller memory not counted */
+size_t acm_mem_usage(ACMStream *acm)
+{
+	size_t n = sizeof(*acm);
+
+	if (acm->buf)
+		n += acm->buf_max + ACM_BUF_PAD;
+	n += (acm->block_max + acm->wrapbuf_max + acm->tile_max) * sizeof(int);
+	n += acm->seek_idx_max * sizeof(ACMSeekPoint);
+	if (acm->seek_wrap)
+		n += (size_t)acm->seek_idx_max * acm->wrapbuf_len * sizeof(int);
+	return n;
+}
+
+/*
+ * statistics
+ */
+
+/* copy counters, fails if built without --enable-stats */
+int acm_get_stats(ACMStream *acm, struct acm_stats *st)
+{
+#ifdef ACM_STATS
+	*st = acm->stats;
+	return ACM_OK;
+#else
+	memset(st, 0, sizeof(*st));
+	return ACM_ERR_NOT_SUPPORTED;
+#endif
+}
+
+#ifdef ACM_STATS
+/* monotonic clock in nanoseconds */
+uint64_t acm_stats_clock(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER now, freq;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&freq);
+	return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000
+		+ (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+#endif
+
 /*
  * seeking
  */
@@ -181,37 +467,288 @@ int acm_seek_time(ACMStream *acm, unsigned time_ms)
 	return pcm2time(acm, res);
 }
 
-int acm_seek_pcm(ACMStream *acm, unsigned pcm_pos)
+/*
+ * Seek index.
+ *
+ * Block sizes in bytes are not stored anywhere, so without an index
+ * a backward seek has to decode everything from the start of file.
+ * The index remembers bit-reader and wrapbuf state at the start
+ * of each block, which is all decode_block() depends on.
+ */
+
+int acm_enable_seek_index(ACMStream *acm)
 {
-	unsigned word_pos = pcm_pos * acm->info.channels;
-	unsigned start_ofs;
+	if (acm->seek_idx != NULL)
+		return 0;
+	acm->seek_idx_max = 16;
+	acm->seek_idx = (ACMSeekPoint*)acm_mem_alloc(acm, acm->seek_idx_max * sizeof(ACMSeekPoint));
+	if (acm->wrapbuf_len > 0)
+		acm->seek_wrap = (int*)acm_mem_alloc(acm, (size_t)acm->seek_idx_max * acm->wrapbuf_len * sizeof(int));
+	if (!acm->seek_idx || (acm->wrapbuf_len > 0 && !acm->seek_wrap)) {
+		acm_free_seek_index(acm);
+		return ACM_ERR_OTHER;
+	}
+	acm->seek_idx_len = 0;
+	return 0;
+}
+
+void acm_free_seek_index(ACMStream *acm)
+{
+	acm_mem_free(acm, acm->seek_idx);
+	acm_mem_free(acm, acm->seek_wrap);
+	acm->seek_idx = NULL;
+	acm->seek_wrap = NULL;
+	acm->seek_idx_len = acm->seek_idx_max = 0;
+}
 
-	if (word_pos < acm->stream_pos) {
+/* remember bit-reader position, must be at block start */
+void acm_save_seek_point(ACMStream *acm, ACMSeekPoint *sp)
+{
+	sp->raw_ofs = acm->buf_start_ofs + acm->buf_pos;
+	/* drop read-ahead bits, those will be loaded again */
+	sp->bit_data = acm->bit_data & (((uint64_t)1 << acm->bit_avail) - 1);
+	sp->bit_avail = acm->bit_avail;
+	sp->stream_pos = acm->stream_pos;
+}
+
+/* called from decode_block() before block header is read */
+void acm_seek_index_add(ACMStream *acm)
+{
+	ACMSeekPoint *sp;
+	unsigned n = acm->stream_pos / acm->block_len, wrap_len;
+
+	/* only in-order blocks, with data still coming from file */
+	if (n != acm->seek_idx_len || acm->file_eof)
+		return;
+	/* loaded without wrapbuf, see acm_load_index(), goes on so */
+	wrap_len = acm->seek_wrap ? acm->wrapbuf_len : 0;
+
+	if (n == acm->seek_idx_max) {
+		unsigned max = acm->seek_idx_max * 2;
+		void *tmp;
+		if (max < acm->seek_idx_max
+		    || max > (size_t)-1 / sizeof(int) / (wrap_len + 1))
+			return;
+		tmp = acm_mem_realloc(acm, acm->seek_idx,
+				acm->seek_idx_max * sizeof(ACMSeekPoint),
+				max * sizeof(ACMSeekPoint));
+		if (!tmp)
+			return;
+		acm->seek_idx = (ACMSeekPoint*)tmp;
+		if (wrap_len > 0) {
+			tmp = acm_mem_realloc(acm, acm->seek_wrap,
+					(size_t)acm->seek_idx_max * acm->wrapbuf_len * sizeof(int),
+					(size_t)max * acm->wrapbuf_len * sizeof(int));
+			if (!tmp)
+				return;
+			acm->seek_wrap = (int*)tmp;
+		}
+		acm->seek_idx_max = max;
+	}
+
+	sp = &acm->seek_idx[n];
+	acm_save_seek_point(acm, sp);
+	if (wrap_len > 0)
+		memcpy(acm->seek_wrap + (size_t)n * acm->wrapbuf_len, acm->wrapbuf,
+				acm->wrapbuf_len * sizeof(int));
+	acm->seek_idx_len++;
+}
+
+/*
+ * Index entry to restore for decoding block n, with its wrapbuf.
+ * Index without wrapbuf starts one block early, from zeroed wrapbuf.
+ */
+const ACMSeekPoint *acm_seek_index_point(ACMStream *acm, unsigned n, const int **wrap)
+{
+	if (n >= acm->seek_idx_len)
+		n = acm->seek_idx_len - 1;
+	if (acm->seek_wrap == NULL && acm->wrapbuf_len > 0) {
+		if (n > 0)
+			n--;
+		*wrap = NULL;
+	} else {
+		*wrap = acm->seek_wrap + (size_t)n * acm->wrapbuf_len;
+	}
+	return &acm->seek_idx[n];
+}
+
+/*
+ * Reposition stream to start of block described by sp.
+ * wrap == NULL clears wrapbuf.
+ */
+int acm_restore_seek_point(ACMStream *acm, const ACMSeekPoint *sp, const int *wrap)
+{
+	/* memory backend needs only buffer reset */
+	if (acm->mem_data == NULL) {
 		if (acm->io.seek_func == NULL)
 			return ACM_ERR_NOT_SEEKABLE;
+		if (acm->io.seek_func(acm->io_arg, sp->raw_ofs, SEEK_SET) < 0)
+			return ACM_ERR_NOT_SEEKABLE;
+	}
 
-		start_ofs = ACM_HEADER_LEN;
-		if (acm->wavc_file)
-			start_ofs += WAVC_HEADER_LEN;
+	acm->file_eof = 0;
+	acm->buf_pos = 0;
+	acm->buf_size = 0;
+	acm->buf_start_ofs = sp->raw_ofs;
+	acm->bit_data = sp->bit_data;
+	acm->bit_avail = sp->bit_avail;
+
+	acm->stream_pos = sp->stream_pos;
+	acm->block_pos = 0;
+	acm->block_ready = 0;
+	acm->split_len = 0;
+
+	if (wrap != NULL)
+		memcpy(acm->wrapbuf, wrap, acm->wrapbuf_len * sizeof(int));
+	else
+		memset(acm->wrapbuf, 0, acm->wrapbuf_len * sizeof(int));
+	return 0;
+}
 
-		if (acm->io.seek_func(acm->io_arg, start_ofs, SEEK_SET) < 0)
-			return ACM_ERR_NOT_SEEKABLE;
-	
-		acm->file_eof = 0;
-		acm->buf_pos = 0;
- 		acm->buf_size = 0;
-		acm->bit_avail = 0;
-		acm->bit_data = 0;
-
-		acm->stream_pos = 0;
-		acm->block_pos = 0;
+int acm_rewind(ACMStream *acm)
+{
+	ACMSeekPoint sp;
+
+	if (acm->pcm_data != NULL)
+		return acm_seek_pcm(acm, 0) < 0 ? ACM_ERR_OTHER : 0;
+
+	memset(&sp, 0, sizeof(sp));
+	sp.raw_ofs = ACM_HEADER_LEN;
+	if (acm->wavc_file)
+		sp.raw_ofs += WAVC_HEADER_LEN;
+	return acm_restore_seek_point(acm, &sp, NULL);
+}
+
+/* decode rest of file, filling the index, then return to old position */
+int acm_build_seek_index(ACMStream *acm)
+{
+	unsigned pcm_pos = acm_pcm_tell(acm);
+	const ACMSeekPoint *sp;
+	const int *wrap;
+	int res, err;
+
+	/* pcm view seeks without index */
+	if (acm->pcm_data != NULL)
+		return 0;
+	if (acm->io.seek_func == NULL && acm->mem_data == NULL)
+		return ACM_ERR_NOT_SEEKABLE;
+	if ((err = acm_enable_seek_index(acm)) < 0)
+		return err;
+
+	/* continue from last known block */
+	if (acm->seek_idx_len > 0) {
+		sp = acm_seek_index_point(acm, acm->seek_idx_len - 1, &wrap);
+		err = acm_restore_seek_point(acm, sp, wrap);
+	} else {
+		err = acm_rewind(acm);
+	}
+	if (err < 0)
+		return err;
+
+	while (1) {
+		res = acm_read(acm, NULL, acm->block_len * ACM_WORD, 0,2,1);
+		if (res < 1)
+			break;
+	}
+
+	err = acm_seek_pcm(acm, pcm_pos);
+	if (res < 0)
+		return res;
+	return err < 0 ? err : 0;
+}
+
+/* old wrapbuf is forgotten after one block, see parallel.c */
+int acm_wrap_independent(ACMStream *acm)
+{
+	return acm->info.acm_level <= 1 || acm->info.acm_rows >= 2;
+}
+
+/*
+ * Parse blocks before word_pos without decoding them.  Block
+ * before target is still decoded, that gives exact wrapbuf.
+ */
+static void skip_blocks(ACMStream *acm, unsigned word_pos)
+{
+	unsigned next, last;
+
+	if (acm->push_mode || !acm_wrap_independent(acm))
+		return;
+
+	/* block at bit reader */
+	if (acm->block_ready)
+		next = (acm->stream_pos - acm->block_pos) / acm->block_len + 1;
+	else
+		next = acm->stream_pos / acm->block_len;
+	last = word_pos / acm->block_len;
+	/* block before target would get index entry with stale wrapbuf */
+	if (acm->seek_idx != NULL && last == acm->seek_idx_len + 1)
+		last--;
+	if (next + 1 >= last)
+		return;
+
+	acm->stream_pos = next * acm->block_len;
+	acm->block_ready = 0;
+	acm->block_pos = 0;
+	acm->split_len = 0;
+	while (acm->stream_pos / acm->block_len + 1 < last) {
+		if (acm_skip_block(acm) <= 0)
+			break;
+		ACM_STAT(acm, seek_skipped++);
+	}
+}
+
+int acm_seek_pcm(ACMStream *acm, unsigned pcm_pos)
+{
+	unsigned word_pos = pcm_pos * acm->info.channels;
+	int err;
+
+	if (word_pos < acm->stream_pos)
+		ACM_STAT(acm, seek_rewind++);
+	else
+		ACM_STAT(acm, seek_forward++);
+
+	/* decoded values in memory, see acm_open_pcm() */
+	if (acm->pcm_data != NULL) {
+		if (word_pos > acm->total_values)
+			word_pos = acm->total_values - acm->total_values % acm->info.channels;
+		acm->stream_pos = word_pos;
 		acm->block_ready = 0;
-		acm->buf_start_ofs = ACM_HEADER_LEN;
+		acm->split_len = 0;
+		return word_pos / acm->info.channels;
+	}
 
-		memset(acm->wrapbuf, 0, acm->wrapbuf_len * sizeof(int));
+	if (acm->seek_idx_len > 0) {
+		const int *wrap;
+		const ACMSeekPoint *sp = acm_seek_index_point(acm,
+				word_pos / acm->block_len, &wrap);
+		/* use checkpoint if behind us, or ahead of current position */
+		if (word_pos < acm->stream_pos
+		    || sp->stream_pos > acm->stream_pos) {
+			err = acm_restore_seek_point(acm, sp, wrap);
+			if (err < 0)
+				return err;
+		}
+	} else if (word_pos < acm->stream_pos) {
+		if ((err = acm_rewind(acm)) < 0)
+			return err;
 	}
+
+	skip_blocks(acm, word_pos);
+
+	/* words from here to target are dropped */
+	ACM_STAT(acm, seek_words -= acm->stream_pos);
 	while (acm->stream_pos < word_pos) {
 		int step = 2048, res;
+
+		/* target inside next block, juggle only up to it */
+		if (!acm->block_ready && !acm->push_mode && acm->info.acm_level > 0
+		    && word_pos - acm->stream_pos < acm->block_len
+		    && word_pos < acm->total_values) {
+			res = acm_seek_block(acm, word_pos);
+			if (res < 0)
+				return res;
+			break;
+		}
 		if (acm->stream_pos + step > word_pos)
 			step = word_pos - acm->stream_pos;
 
@@ -219,11 +756,15 @@ int acm_seek_pcm(ACMStream *acm, unsigned pcm_pos)
 		if (res < 1)
 			break;
 	}
+	ACM_STAT(acm, seek_words += acm->stream_pos);
 	return acm->stream_pos / acm->info.channels;
 }
 
 /*
  * read loop - full block reading
+ *
+ * On push streams it decodes what fed data allows and returns
+ * ACM_NEED_MORE_DATA if nothing could be decoded yet.
  */
 int acm_read_loop(ACMStream *acm, void *dst, unsigned bytes,
 		int bigendianp, int wordlen, int sgned)
@@ -245,3 +786,26 @@ int acm_read_loop(ACMStream *acm, void *dst, unsigned bytes,
 	}
 	return got;
 }
+
+/* error strings, index is -err */
+static const char *acm_errlist[] = {
+	"No error",
+	"ACM error",
+	"Cannot open file",
+	"Not an ACM file",
+	"Read error",
+	"Bad format",
+	"Corrupt file",
+	"Unexpected EOF",
+	"Stream not seekable",
+	"Need more data",
+	"Not supported in this build"
+};
+
+const char *acm_strerror(int err)
+{
+	int nerr = sizeof(acm_errlist) / sizeof(char *);
+	if ((-err) < 0 || (-err) >= nerr)
+		return "Unknown error";
+	return acm_errlist[-err];
+}